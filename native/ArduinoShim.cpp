@@ -0,0 +1,42 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+
+HostSerial Serial;
+int nativeBatteryMilliVolts = 1950;
+
+static const auto startTime = std::chrono::steady_clock::now();
+
+unsigned long millis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long micros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+char *itoa(int value, char *str, int base) {
+    if (base == 10) {
+        sprintf(str, "%d", value);
+        return str;
+    }
+    char digits[33];
+    int n = 0;
+    unsigned int v = value;
+    do {
+        digits[n++] = "0123456789abcdefghijklmnopqrstuvwxyz"[v % base];
+        v /= base;
+    } while (v);
+    for (int i = 0; i < n; i++) str[i] = digits[n - 1 - i];
+    str[n] = '\0';
+    return str;
+}
+
+char *dtostrf(double value, signed char width, unsigned char prec, char *str) {
+    sprintf(str, "%*.*f", width, prec, value);
+    return str;
+}
@@ -0,0 +1,153 @@
+#include <FS.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+    class FileImpl {
+    public:
+        ~FileImpl() { close(); }
+        void close() {
+            if (file) fclose(file);
+            if (dir) closedir(dir);
+            file = nullptr;
+            dir = nullptr;
+        }
+
+        FILE *file = nullptr;
+        DIR *dir = nullptr;
+        std::string hostPath; // where it is on the host
+        std::string path;     // as the firmware named it
+        std::string name;
+        FS *fs = nullptr;
+    };
+
+    size_t File::write(uint8_t c) { return write(&c, 1); }
+
+    size_t File::write(const uint8_t *buf, size_t size) {
+        if (!_impl || !_impl->file) return 0;
+        size_t n = fwrite(buf, 1, size, _impl->file);
+        _impl->fs->stats().bytesWritten += n;
+        return n;
+    }
+
+    int File::available() {
+        if (!_impl || !_impl->file) return 0;
+        return (int)(size() - position());
+    }
+
+    int File::read() {
+        uint8_t c;
+        return read(&c, 1) == 1 ? c : -1;
+    }
+
+    int File::peek() {
+        if (!_impl || !_impl->file) return -1;
+        int c = fgetc(_impl->file);
+        if (c != EOF) ungetc(c, _impl->file);
+        return c == EOF ? -1 : c;
+    }
+
+    void File::flush() {
+        if (_impl && _impl->file) fflush(_impl->file);
+    }
+
+    size_t File::read(uint8_t *buf, size_t size) {
+        if (!_impl || !_impl->file) return 0;
+        size_t n = fread(buf, 1, size, _impl->file);
+        _impl->fs->stats().bytesRead += n;
+        return n;
+    }
+
+    bool File::seek(uint32_t pos, SeekMode mode) {
+        if (!_impl || !_impl->file) return false;
+        int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+        return fseek(_impl->file, pos, whence) == 0;
+    }
+
+    size_t File::position() const {
+        if (!_impl || !_impl->file) return 0;
+        return ftell(_impl->file);
+    }
+
+    size_t File::size() const {
+        if (!_impl || !_impl->file) return 0;
+        fflush(_impl->file);
+        struct stat st;
+        return fstat(fileno(_impl->file), &st) == 0 ? st.st_size : 0;
+    }
+
+    void File::close() {
+        if (_impl) _impl->close();
+        _impl.reset();
+    }
+
+    File::operator bool() const { return _impl && (_impl->file || _impl->dir); }
+
+    const char *File::path() const { return _impl ? _impl->path.c_str() : ""; }
+
+    const char *File::name() const { return _impl ? _impl->name.c_str() : ""; }
+
+    bool File::isDirectory() const { return _impl && _impl->dir; }
+
+    File File::openNextFile(const char *mode) {
+        if (!_impl || !_impl->dir) return File();
+        struct dirent *entry;
+        while ((entry = readdir(_impl->dir))) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            std::string child = _impl->path;
+            if (child.empty() || child.back() != '/') child += '/';
+            child += entry->d_name;
+            return _impl->fs->open(child.c_str(), mode);
+        }
+        return File();
+    }
+
+    std::string FS::hostPath(const char *path) const {
+        return _root + (path[0] == '/' ? "" : "/") + path;
+    }
+
+    File FS::open(const char *path, const char *mode, bool create) {
+        auto impl = std::make_shared<FileImpl>();
+        impl->hostPath = hostPath(path);
+        impl->path = path;
+        const char *slash = strrchr(path, '/');
+        impl->name = slash ? slash + 1 : path;
+        impl->fs = this;
+
+        struct stat st;
+        if (strcmp(mode, FILE_READ) == 0 && stat(impl->hostPath.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+            impl->dir = opendir(impl->hostPath.c_str());
+        } else {
+            // Arduino's "r+" opens for update; the others map straight onto stdio
+            std::string m = strcmp(mode, "r+") == 0 ? "r+b" : std::string(mode) + "b";
+            impl->file = fopen(impl->hostPath.c_str(), m.c_str());
+        }
+        if (!impl->file && !impl->dir) return File();
+        _stats.opens++;
+        return File(impl);
+    }
+
+    bool FS::exists(const char *path) {
+        struct stat st;
+        return stat(hostPath(path).c_str(), &st) == 0;
+    }
+
+    bool FS::remove(const char *path) {
+        _stats.removes++;
+        return ::unlink(hostPath(path).c_str()) == 0;
+    }
+
+    bool FS::rename(const char *from, const char *to) {
+        _stats.renames++;
+        // FAT will not rename over an existing file, so neither does this
+        if (exists(to)) return false;
+        return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+    }
+
+    bool FS::mkdir(const char *path) { return ::mkdir(hostPath(path).c_str(), 0755) == 0; }
+
+    bool FS::rmdir(const char *path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+}
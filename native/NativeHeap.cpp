@@ -0,0 +1,66 @@
+#include <NativeHeap.h>
+#include <new>
+#include <stdlib.h>
+
+namespace {
+
+    // Ahead of every block, keeping the caller's pointer max-aligned
+    union Header {
+        size_t size;
+        max_align_t align;
+    };
+
+    size_t live = 0;
+    size_t highWater = 0;
+
+}
+
+namespace NativeHeap {
+
+    void *allocate(size_t size) {
+        Header *h = (Header *)malloc(sizeof(Header) + size);
+        if (h == nullptr) return nullptr;
+        h->size = size;
+        live += size;
+        if (live > highWater) highWater = live;
+        return h + 1;
+    }
+
+    void *reallocate(void *ptr, size_t size) {
+        if (ptr == nullptr) return allocate(size);
+        Header *h = (Header *)realloc((Header *)ptr - 1, sizeof(Header) + size);
+        if (h == nullptr) return nullptr;
+        live = live - h->size + size;
+        if (live > highWater) highWater = live;
+        h->size = size;
+        return h + 1;
+    }
+
+    void release(void *ptr) {
+        if (ptr == nullptr) return;
+        Header *h = (Header *)ptr - 1;
+        live -= h->size;
+        free(h);
+    }
+
+    size_t current() { return live; }
+
+    size_t peak() { return highWater; }
+
+    void resetPeak() { highWater = live; }
+
+}
+
+void *operator new(size_t size) {
+    void *p = NativeHeap::allocate(size);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return NativeHeap::allocate(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return NativeHeap::allocate(size); }
+void operator delete(void *ptr) noexcept { NativeHeap::release(ptr); }
+void operator delete[](void *ptr) noexcept { NativeHeap::release(ptr); }
+void operator delete(void *ptr, size_t) noexcept { NativeHeap::release(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { NativeHeap::release(ptr); }
@@ -0,0 +1,61 @@
+#include <Preferences.h>
+
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> &storage() {
+    static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> namespaces;
+    return namespaces;
+}
+
+bool Preferences::begin(const char *name, bool readOnly) {
+    // NVS limits namespace names to 15 characters
+    if (name == nullptr || strlen(name) > 15) return false;
+    _ns = &storage()[name];
+    _readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    _ns = nullptr;
+}
+
+bool Preferences::clear() {
+    if (!_ns || _readOnly) return false;
+    _ns->clear();
+    return true;
+}
+
+bool Preferences::remove(const char *key) {
+    if (!_ns || _readOnly) return false;
+    return _ns->erase(key) > 0;
+}
+
+bool Preferences::isKey(const char *key) {
+    return _ns && _ns->count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len) {
+    if (!_ns || _readOnly || key == nullptr || value == nullptr) return 0;
+    const uint8_t *bytes = (const uint8_t *)value;
+    (*_ns)[key].assign(bytes, bytes + len);
+    return len;
+}
+
+String Preferences::getString(const char *key, const String &defaultValue) {
+    if (!isKey(key)) return defaultValue;
+    const std::vector<uint8_t> &value = (*_ns)[key];
+    return String(std::string(value.begin(), std::find(value.begin(), value.end(), 0)));
+}
+
+size_t Preferences::getBytesLength(const char *key) {
+    return isKey(key) ? (*_ns)[key].size() : 0;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen) {
+    size_t len = getBytesLength(key);
+    if (len == 0 || len > maxLen) return 0;
+    memcpy(buf, (*_ns)[key].data(), len);
+    return len;
+}
+
+void Preferences::eraseAll() {
+    storage().clear();
+}
@@ -0,0 +1,172 @@
+#include "Codec.h"
+#include <ArduinoJson.h>
+#include <NativeHeap.h>
+#include <chrono>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include "../../src/HistoryCodec.h"
+
+// Decodes are repeated so a short history still takes measurable time
+static const int DECODE_PASSES = 20;
+
+typedef std::map<int, std::vector<HistorySample>> Samples;
+
+// ArduinoJson takes its memory from malloc(); this counts it with the rest
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    void *allocate(size_t size) override { return NativeHeap::allocate(size); }
+    void deallocate(void *ptr) override { NativeHeap::release(ptr); }
+    void *reallocate(void *ptr, size_t size) override { return NativeHeap::reallocate(ptr, size); }
+};
+static CountingAllocator countingAllocator;
+
+struct Result {
+    const char *format;
+    size_t bytes;
+    double encodeMs;
+    double decodeMs; // one pass
+    size_t peakHeap;
+    bool identical;
+};
+
+static bool sameSamples(const Samples &a, const Samples &b) {
+    if (a.size() != b.size())
+        return false;
+    for (auto i = a.begin(), j = b.begin(); i != a.end(); ++i, ++j) {
+        if (i->first != j->first || i->second.size() != j->second.size())
+            return false;
+        for (size_t k = 0; k < i->second.size(); k++) {
+            const HistorySample &x = i->second[k], &y = j->second[k];
+            if (x.timestamp != y.timestamp || x.weightGrams != y.weightGrams || x.durationSeconds != y.durationSeconds)
+                return false;
+        }
+    }
+    return true;
+}
+
+// UTC year and month as YYYYMM, as the shards are keyed
+static uint32_t monthOf(time_t ts) {
+    struct tm t;
+    gmtime_r(&ts, &t);
+    return (t.tm_year + 1900) * 100 + t.tm_mon + 1;
+}
+
+static double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Runs decode DECODE_PASSES times; out keeps the last pass
+template <typename F>
+static void timeDecode(Result &result, Samples &out, F decode) {
+    NativeHeap::resetPeak();
+    size_t heapStart = NativeHeap::current();
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < DECODE_PASSES; pass++) {
+        out.clear();
+        decode(out);
+    }
+    result.decodeMs = msSince(start) / DECODE_PASSES;
+    result.peakHeap = NativeHeap::peak() - heapStart;
+}
+
+// The legacy document: {"<pet id>": [{"ts": ..., "w_g": ..., "dur_s": ...}, ...]}
+static Result runJson(const Samples &samples) {
+    Result result = {"json", 0, 0, 0, 0, false};
+    std::string text;
+    auto start = std::chrono::steady_clock::now();
+    {
+        JsonDocument doc(&countingAllocator);
+        JsonObject root = doc.to<JsonObject>();
+        for (const auto &pet : samples) {
+            JsonArray records = root[std::to_string(pet.first)].to<JsonArray>();
+            for (const HistorySample &sample : pet.second) {
+                JsonObject record = records.add<JsonObject>();
+                record["ts"] = sample.timestamp;
+                record["w_g"] = sample.weightGrams;
+                record["dur_s"] = sample.durationSeconds;
+            }
+        }
+        serializeJson(doc, text);
+    }
+    result.encodeMs = msSince(start);
+    result.bytes = text.size();
+
+    Samples decoded;
+    timeDecode(result, decoded, [&](Samples &out) {
+        JsonDocument doc(&countingAllocator);
+        if (deserializeJson(doc, text)) return;
+        for (JsonPair pet : doc.as<JsonObject>()) {
+            std::vector<HistorySample> &series = out[atoi(pet.key().c_str())];
+            for (JsonObject record : pet.value().as<JsonArray>())
+                series.push_back({record["ts"].as<uint32_t>(), record["w_g"].as<int32_t>(), record["dur_s"].as<int32_t>()});
+        }
+    });
+    result.identical = sameSamples(decoded, samples);
+    return result;
+}
+
+// One block per pet and UTC month, as in the shards
+static Result runBlocks(const Samples &samples) {
+    Result result = {"codec", 0, 0, 0, 0, false};
+    std::vector<std::pair<int, std::vector<uint8_t>>> blocks;
+    auto start = std::chrono::steady_clock::now();
+    for (const auto &pet : samples) {
+        const std::vector<HistorySample> &series = pet.second;
+        for (size_t first = 0; first < series.size();) {
+            uint32_t month = monthOf(series[first].timestamp);
+            size_t last = first + 1;
+            while (last < series.size() && monthOf(series[last].timestamp) == month)
+                last++;
+            blocks.push_back({pet.first, {}});
+            result.bytes += HistoryCodec::encodeBlock(series.data() + first, last - first, blocks.back().second);
+            first = last;
+        }
+    }
+    result.encodeMs = msSince(start);
+
+    Samples decoded;
+    timeDecode(result, decoded, [&](Samples &out) {
+        for (const auto &block : blocks)
+            HistoryCodec::decodeBlock(block.second.data(), block.second.size(), out[block.first]);
+    });
+    result.identical = sameSamples(decoded, samples);
+    return result;
+}
+
+bool runCodec(const WorkloadConfig &config, const std::vector<int> &days, time_t end, bool json) {
+    bool allIdentical = true;
+    if (!json)
+        printf("days,pets,records,format,bytes,bytes_per_record,encode_ms,decode_ms,records_per_ms,peak_heap,identical\n");
+    for (int length : days) {
+        WorkloadConfig lengthConfig = config;
+        lengthConfig.days = length;
+        Workload workload(lengthConfig, end);
+        time_t start = end - (time_t)length * 86400;
+
+        Samples samples;
+        size_t records = 0;
+        for (int petId : workload.petIds()) {
+            for (const LitterboxRecord &rec : workload.records(petId, start, end))
+                samples[petId].push_back({(uint32_t)rec.timestamp, rec.weight_grams, rec.duration_seconds});
+            records += samples[petId].size();
+        }
+
+        for (const Result &result : {runJson(samples), runBlocks(samples)}) {
+            allIdentical &= result.identical;
+            double perRecord = records > 0 ? (double)result.bytes / records : 0;
+            double throughput = result.decodeMs > 0 ? records / result.decodeMs : 0;
+            if (json)
+                printf("{\"days\":%d,\"pets\":%d,\"records\":%zu,\"format\":\"%s\",\"bytes\":%zu,\"bytes_per_record\":%.2f,"
+                       "\"encode_ms\":%.3f,\"decode_ms\":%.3f,\"records_per_ms\":%.0f,\"peak_heap\":%zu,\"identical\":%s}\n",
+                       length, config.pets, records, result.format, result.bytes, perRecord, result.encodeMs,
+                       result.decodeMs, throughput, result.peakHeap, result.identical ? "true" : "false");
+            else
+                printf("%d,%d,%zu,%s,%zu,%.2f,%.3f,%.3f,%.0f,%zu,%s\n", length, config.pets, records, result.format,
+                       result.bytes, perRecord, result.encodeMs, result.decodeMs, throughput, result.peakHeap,
+                       result.identical ? "yes" : "no");
+            fflush(stdout);
+        }
+    }
+    return allIdentical;
+}
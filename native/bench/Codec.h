@@ -0,0 +1,20 @@
+#ifndef CODEC_H
+#define CODEC_H
+
+#include <time.h>
+#include <vector>
+#include "Workload.h"
+
+/**
+ * @brief Compares HistoryCodec with the JSON history it replaced.
+ *
+ * For each history length, the workload's visits are encoded once as the
+ * old /pet_data.json document and once as HistoryCodec blocks, one per pet
+ * and UTC month as in the shards, then decoded back to samples. One row per
+ * format gives the size, bytes per record, encode and decode time, decode
+ * throughput, the peak heap while decoding and whether the decoded samples
+ * match the workload. Returns false if any did not.
+ */
+bool runCodec(const WorkloadConfig &config, const std::vector<int> &days, time_t end, bool json);
+
+#endif
@@ -0,0 +1,183 @@
+#include "Containers.h"
+#include <NativeHeap.h>
+#include <chrono>
+#include <map>
+#include <random>
+#include <stdio.h>
+#include "../../src/PetHistory.h"
+
+// PetDataMap before PetSeries: PetID -> Timestamp -> Record
+typedef std::map<int, std::map<time_t, LitterboxRecord>> NestedMap;
+
+static const time_t WAKE_SECONDS = 2 * 3600;
+static const int LOOKUPS = 100000;
+static const int RANGE_DAYS[] = {7, 30, 90, 365};
+
+// What a wake fetches and what is looked up, the same for both containers
+struct Inputs {
+    std::vector<int> petIds;
+    std::map<int, std::vector<LitterboxRecord>> loaded;
+    std::vector<std::map<int, std::vector<LitterboxRecord>>> fetches;
+    std::vector<std::pair<int, time_t>> lookups;
+    time_t now; // after the last wake
+};
+
+// What each operation returned, compared between the containers
+struct Answers {
+    size_t merged = 0;
+    size_t found = 0;
+    int64_t scanned = 0;
+};
+
+struct Row {
+    const char *op;
+    int calls;
+    double ms;
+    size_t peakHeap;
+};
+
+template <typename F>
+static Row measure(const char *op, int calls, F f) {
+    NativeHeap::resetPeak();
+    size_t heapStart = NativeHeap::current();
+    auto start = std::chrono::steady_clock::now();
+    f();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return {op, calls, ms, NativeHeap::peak() - heapStart};
+}
+
+static std::vector<Row> runNested(const Inputs &in, Answers &answers) {
+    std::vector<Row> rows;
+    NestedMap data;
+    rows.push_back(measure("build", 1, [&] {
+        for (const auto &pet : in.loaded)
+            for (const LitterboxRecord &rec : pet.second)
+                data[pet.first][rec.timestamp] = rec;
+    }));
+    rows.push_back(measure("merge", (int)in.fetches.size(), [&] {
+        for (const auto &fetch : in.fetches) {
+            for (const auto &pet : fetch) {
+                std::map<time_t, LitterboxRecord> &series = data[pet.first];
+                for (const LitterboxRecord &rec : pet.second) {
+                    auto it = series.find(rec.timestamp);
+                    if (it != series.end() && it->second.weight_grams == rec.weight_grams &&
+                        it->second.duration_seconds == rec.duration_seconds)
+                        continue;
+                    series[rec.timestamp] = rec;
+                    answers.merged++;
+                }
+            }
+        }
+    }));
+    rows.push_back(measure("lookup", LOOKUPS, [&] {
+        for (const auto &lookup : in.lookups) {
+            const std::map<time_t, LitterboxRecord> &series = data[lookup.first];
+            if (series.find(lookup.second) != series.end())
+                answers.found++;
+        }
+    }));
+    rows.push_back(measure("range_scan", (int)(sizeof(RANGE_DAYS) / sizeof(RANGE_DAYS[0]) * in.petIds.size()), [&] {
+        for (int days : RANGE_DAYS) {
+            for (const auto &pet : data) {
+                for (auto it = pet.second.lower_bound(in.now - days * 86400L); it != pet.second.end(); ++it)
+                    answers.scanned += it->second.weight_grams;
+            }
+        }
+    }));
+    return rows;
+}
+
+static std::vector<Row> runSeries(const Inputs &in, Answers &answers) {
+    std::vector<Row> rows;
+    PetDataMap data;
+    rows.push_back(measure("build", 1, [&] {
+        for (const auto &pet : in.loaded) {
+            PetSeries &series = data[pet.first];
+            series.reserve(pet.second.size());
+            for (const LitterboxRecord &rec : pet.second)
+                series.insert(rec.timestamp, rec.weight_grams, rec.duration_seconds);
+        }
+    }));
+    rows.push_back(measure("merge", (int)in.fetches.size(), [&] {
+        for (const auto &fetch : in.fetches)
+            for (const auto &pet : fetch)
+                answers.merged += data[pet.first].merge(pet.second.data(), pet.second.size());
+    }));
+    rows.push_back(measure("lookup", LOOKUPS, [&] {
+        for (const auto &lookup : in.lookups) {
+            const PetSeries &series = data[lookup.first];
+            size_t i = series.lowerBound(lookup.second);
+            if (i < series.size() && series.timestamp(i) == lookup.second)
+                answers.found++;
+        }
+    }));
+    rows.push_back(measure("range_scan", (int)(sizeof(RANGE_DAYS) / sizeof(RANGE_DAYS[0]) * in.petIds.size()), [&] {
+        for (int days : RANGE_DAYS) {
+            for (const PetSeries &series : data) {
+                for (size_t i = series.lowerBound(in.now - days * 86400L); i < series.size(); i++)
+                    answers.scanned += series.weight(i);
+            }
+        }
+    }));
+    return rows;
+}
+
+bool runContainers(const WorkloadConfig &config, const std::vector<int> &days, int wakes, time_t end, bool json) {
+    bool allAgree = true;
+    if (!json)
+        printf("days,pets,records,container,op,calls,ms,peak_heap\n");
+    for (int length : days) {
+        WorkloadConfig lengthConfig = config;
+        lengthConfig.days = length;
+        Workload workload(lengthConfig, end);
+
+        // Loaded up to end, then each wake fetches its last day again with
+        // what is new, as the API returns it
+        Inputs in;
+        in.petIds = workload.petIds();
+        size_t records = 0;
+        for (int petId : in.petIds) {
+            in.loaded[petId] = workload.records(petId, end - (time_t)length * 86400, end);
+            records += in.loaded[petId].size();
+        }
+        in.now = end;
+        for (int w = 0; w < wakes; w++) {
+            in.now += WAKE_SECONDS;
+            in.fetches.emplace_back();
+            for (int petId : in.petIds)
+                in.fetches.back()[petId] = workload.records(petId, in.now - 86400, in.now);
+        }
+        std::mt19937 rng(config.seed);
+        std::uniform_int_distribution<size_t> pet(0, in.petIds.size() - 1);
+        for (int i = 0; i < LOOKUPS; i++) {
+            const std::vector<LitterboxRecord> &loaded = in.loaded[in.petIds[pet(rng)]];
+            if (loaded.empty())
+                continue;
+            // Every other one a timestamp that is not held
+            const LitterboxRecord &rec = loaded[std::uniform_int_distribution<size_t>(0, loaded.size() - 1)(rng)];
+            in.lookups.push_back({rec.pet_id, rec.timestamp + (i & 1)});
+        }
+
+        Answers nestedAnswers, seriesAnswers;
+        std::vector<Row> nested = runNested(in, nestedAnswers);
+        std::vector<Row> series = runSeries(in, seriesAnswers);
+        allAgree &= nestedAnswers.merged == seriesAnswers.merged && nestedAnswers.found == seriesAnswers.found &&
+                    nestedAnswers.scanned == seriesAnswers.scanned;
+
+        for (const auto &container : {std::make_pair("std_map", &nested), std::make_pair("pet_series", &series)}) {
+            for (const Row &row : *container.second) {
+                if (json)
+                    printf("{\"days\":%d,\"pets\":%d,\"records\":%zu,\"container\":\"%s\",\"op\":\"%s\",\"calls\":%d,"
+                           "\"ms\":%.3f,\"peak_heap\":%zu}\n",
+                           length, config.pets, records, container.first, row.op, row.calls, row.ms, row.peakHeap);
+                else
+                    printf("%d,%d,%zu,%s,%s,%d,%.3f,%zu\n", length, config.pets, records, container.first, row.op,
+                           row.calls, row.ms, row.peakHeap);
+            }
+        }
+        fflush(stdout);
+    }
+    if (!allAgree)
+        fprintf(stderr, "The containers disagreed\n");
+    return allAgree;
+}
@@ -0,0 +1,20 @@
+#ifndef CONTAINERS_H
+#define CONTAINERS_H
+
+#include <time.h>
+#include <vector>
+#include "Workload.h"
+
+/**
+ * @brief Compares PetDataMap's PetSeries with the nested std::map it replaced.
+ *
+ * For each history length, both containers are filled with the workload as
+ * loadData() fills them, take a run of two-hourly wakes' fetches as
+ * mergeData() merges them, answer point lookups and scan each date range as
+ * the plots do. One row per container and operation gives the time and the
+ * peak heap; the build row's heap is what the history takes to hold.
+ * Returns false if the two disagreed on any result.
+ */
+bool runContainers(const WorkloadConfig &config, const std::vector<int> &days, int wakes, time_t end, bool json);
+
+#endif
@@ -0,0 +1,145 @@
+#include "Primitives.h"
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "../../src/config.h"
+#include "../../src/FrameCanvas.h"
+
+// FrameCanvas with its direct writes routed back to the generic versions,
+// so everything ends up in drawPixel as before
+class ReferenceCanvas : public FrameCanvas {
+public:
+    ReferenceCanvas() : FrameCanvas(EPD_WIDTH, EPD_HEIGHT) {}
+
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+        Adafruit_GFX::drawFastVLine(x, y, h, color);
+    }
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+        Adafruit_GFX::drawFastHLine(x, y, w, color);
+    }
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+        Adafruit_GFX::fillRect(x, y, w, h, color);
+    }
+    void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override {
+        Adafruit_GFX::writeLine(x0, y0, x1, y1, color);
+    }
+    void fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2) override {
+        PlotSurface::fillChecker(x0, y0, w, h, color1, color2);
+    }
+    void fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color) override {
+        PlotSurface::fillHatch(x0, y0, w, h, spacing, color);
+    }
+    void drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off) override {
+        PlotSurface::drawDashedHLine(x0, y0, length, color, on, off);
+    }
+    void drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off) override {
+        PlotSurface::drawDashedVLine(x0, y0, length, color, on, off);
+    }
+    void drawSprite(int16_t x, int16_t y, const Sprite &sprite) override {
+        PlotSurface::drawSprite(x, y, sprite);
+    }
+};
+
+// Where one call draws: a line from x, y of length w, or a w by h rectangle
+struct Placement {
+    int16_t x, y, w, h;
+    uint16_t color1, color2;
+};
+
+struct Primitive {
+    const char *name;
+    int calls;
+    int16_t maxW, maxH;
+    void (*draw)(PlotSurface &, const Placement &);
+};
+
+#if (EPD_SELECT == 1002)
+static const uint16_t COLORS[] = {EPD_BLACK, EPD_WHITE, EPD_RED, EPD_GREEN, EPD_BLUE, EPD_YELLOW};
+#else
+static const uint16_t COLORS[] = {EPD_BLACK, EPD_WHITE};
+#endif
+
+// The color panel's scatter plot marker
+static const Sprite &marker() {
+    static const Sprite sprite = [] {
+        SpriteRecorder recorder;
+        recorder.fillCircle(0, 0, 3, EPD_WHITE);
+        recorder.drawCircle(0, 0, 3, EPD_BLACK);
+        recorder.drawCircle(0, 0, 1, EPD_BLACK);
+        return recorder.sprite();
+    }();
+    return sprite;
+}
+
+// Sizes are those of the dashboard: grid lines across a plot, bars up to
+// a plot high
+static const Primitive PRIMITIVES[] = {
+    {"hline", 20000, 400, 1, [](PlotSurface &s, const Placement &p) { s.drawFastHLine(p.x, p.y, p.w, p.color1); }},
+    {"vline", 20000, 300, 1, [](PlotSurface &s, const Placement &p) { s.drawFastVLine(p.x, p.y, p.w, p.color1); }},
+    {"rect", 2000, 60, 200, [](PlotSurface &s, const Placement &p) { s.fillRect(p.x, p.y, p.w, p.h, p.color1); }},
+    {"line", 5000, 200, 200, [](PlotSurface &s, const Placement &p) {
+         s.drawLine(p.x, p.y, p.x + p.w, p.y + p.h - 100, p.color1);
+     }},
+    {"checker", 2000, 60, 200, [](PlotSurface &s, const Placement &p) {
+         s.fillChecker(p.x, p.y, p.w, p.h, p.color1, p.color2);
+     }},
+    {"hatch", 2000, 60, 200, [](PlotSurface &s, const Placement &p) { s.fillHatch(p.x, p.y, p.w, p.h, 4, p.color1); }},
+    {"dashed_hline", 5000, 600, 1, [](PlotSurface &s, const Placement &p) {
+         s.drawDashedHLine(p.x, p.y, p.w, p.color1, 2, 2);
+     }},
+    {"dashed_vline", 5000, 400, 1, [](PlotSurface &s, const Placement &p) {
+         s.drawDashedVLine(p.x, p.y, p.w, p.color1, 2, 2);
+     }},
+    {"marker", 20000, 1, 1, [](PlotSurface &s, const Placement &p) { s.drawSprite(p.x, p.y, marker()); }},
+};
+
+// Random placements, some running past the edges of the panel
+static std::vector<Placement> place(const Primitive &primitive, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> x(-20, EPD_WIDTH - 1), y(-20, EPD_HEIGHT - 1);
+    std::uniform_int_distribution<int> w(1, primitive.maxW), h(1, primitive.maxH);
+    std::uniform_int_distribution<size_t> color(0, sizeof(COLORS) / sizeof(COLORS[0]) - 1);
+    std::vector<Placement> placements;
+    for (int i = 0; i < primitive.calls; i++)
+        placements.push_back({(int16_t)x(rng), (int16_t)y(rng), (int16_t)w(rng), (int16_t)h(rng), COLORS[color(rng)],
+                              COLORS[color(rng)]});
+    return placements;
+}
+
+static double timeCalls(FrameCanvas &canvas, const Primitive &primitive, const std::vector<Placement> &placements) {
+    canvas.fillScreen(EPD_WHITE);
+    auto start = std::chrono::steady_clock::now();
+    for (const Placement &placement : placements)
+        primitive.draw(canvas, placement);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool runPrimitives(uint32_t seed, bool json) {
+    ReferenceCanvas reference;
+    FrameCanvas direct(EPD_WIDTH, EPD_HEIGHT);
+    bool allIdentical = true;
+
+    if (!json)
+        printf("layout,primitive,calls,reference_ms,direct_ms,speedup,identical\n");
+    for (const Primitive &primitive : PRIMITIVES) {
+        std::vector<Placement> placements = place(primitive, seed);
+        double referenceMs = timeCalls(reference, primitive, placements);
+        double directMs = timeCalls(direct, primitive, placements);
+        bool identical = memcmp(reference.buffer(), direct.buffer(), direct.bufferSize()) == 0;
+        allIdentical &= identical;
+        double speedup = directMs > 0 ? referenceMs / directMs : 0;
+
+        if (json)
+            printf("{\"layout\":%d,\"primitive\":\"%s\",\"calls\":%d,\"reference_ms\":%.3f,\"direct_ms\":%.3f,"
+                   "\"speedup\":%.1f,\"identical\":%s}\n",
+                   EPD_SELECT, primitive.name, primitive.calls, referenceMs, directMs, speedup,
+                   identical ? "true" : "false");
+        else
+            printf("%d,%s,%d,%.3f,%.3f,%.1f,%s\n", EPD_SELECT, primitive.name, primitive.calls, referenceMs, directMs,
+                   speedup, identical ? "yes" : "no");
+        fflush(stdout);
+    }
+    return allIdentical;
+}
@@ -0,0 +1,17 @@
+#ifndef PRIMITIVES_H
+#define PRIMITIVES_H
+
+#include <stdint.h>
+
+/**
+ * @brief Times each drawing primitive the plots use on FrameCanvas.
+ *
+ * Every primitive is drawn twice from the same random placements: once
+ * pixel by pixel through the Adafruit_GFX and PlotSurface defaults, once
+ * through FrameCanvas's direct span writes. One row per primitive gives
+ * both times, the speedup and whether the two buffers came out identical.
+ * Returns false if any of them differed.
+ */
+bool runPrimitives(uint32_t seed, bool json);
+
+#endif
@@ -0,0 +1,52 @@
+#include "Workload.h"
+#include <algorithm>
+#include <random>
+
+Workload::Workload(const WorkloadConfig &config, time_t end) {
+    std::mt19937 rng(config.seed);
+    std::poisson_distribution<int> visits(config.visitsPerDay);
+    std::normal_distribution<float> drift(0, config.weightDriftGrams);
+    std::normal_distribution<float> noise(0, config.weightNoiseGrams);
+    std::lognormal_distribution<float> duration(logf(config.durationMeanSeconds), config.durationSpread);
+    std::uniform_int_distribution<int> second(0, 86399);
+
+    time_t first = (end - (time_t)config.days * 86400) / 86400 * 86400;
+    for (int p = 0; p < config.pets; p++) {
+        int petId = 100000 + p;
+        _petIds.push_back(petId);
+        std::vector<LitterboxRecord> &out = _records[petId];
+        float weight = config.startWeightGrams + 600 * p;
+
+        for (time_t day = first; day < end + 86400; day += 86400) {
+            weight += drift(rng);
+            int count = visits(rng);
+            size_t dayStart = out.size();
+            for (int v = 0; v < count; v++) {
+                out.push_back({day + second(rng), petId, (int)lroundf(weight + noise(rng)),
+                               std::max(10, (int)lroundf(duration(rng)))});
+            }
+            std::sort(out.begin() + dayStart, out.end(), [](const LitterboxRecord &a, const LitterboxRecord &b) {
+                return a.timestamp < b.timestamp;
+            });
+            // One visit per pet per second at most, as the API reports them
+            out.erase(std::unique(out.begin() + dayStart, out.end(), [](const LitterboxRecord &a, const LitterboxRecord &b) {
+                return a.timestamp == b.timestamp;
+            }), out.end());
+        }
+    }
+}
+
+std::vector<LitterboxRecord> Workload::records(int petId, time_t from, time_t to) const {
+    auto it = _records.find(petId);
+    if (it == _records.end()) return {};
+    auto byTime = [](const LitterboxRecord &r, time_t ts) { return r.timestamp < ts; };
+    auto lo = std::lower_bound(it->second.begin(), it->second.end(), from, byTime);
+    auto hi = std::lower_bound(lo, it->second.end(), to, byTime);
+    return std::vector<LitterboxRecord>(lo, hi);
+}
+
+size_t Workload::totalRecords(time_t from, time_t to) const {
+    size_t total = 0;
+    for (int petId : _petIds) total += records(petId, from, to).size();
+    return total;
+}
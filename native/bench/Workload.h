@@ -0,0 +1,44 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <Arduino.h>
+#include <PetKitApi.h>
+#include <map>
+#include <vector>
+
+struct WorkloadConfig {
+    int pets = 4;
+    int days = 365;
+    float visitsPerDay = 5;          // mean; each day draws from a Poisson distribution
+    float startWeightGrams = 4500;   // first pet; the others step up by 600 g
+    float weightDriftGrams = 12;     // standard deviation of the day-to-day change
+    float weightNoiseGrams = 90;     // scale noise on each visit
+    float durationMeanSeconds = 150; // log-normal, so a few long visits
+    float durationSpread = 0.45;     // sigma of the log
+    uint32_t seed = 1;
+};
+
+/**
+ * @brief Deterministic litter box history for a number of pets.
+ *
+ * Visits run from `days` before end to a day after it, so a benchmark can
+ * keep fetching "new" records after the backfill. The same config and end
+ * always give the same records.
+ */
+class Workload {
+public:
+    Workload(const WorkloadConfig &config, time_t end);
+
+    const std::vector<int> &petIds() const { return _petIds; }
+
+    // Visits of one pet in [from, to), oldest first
+    std::vector<LitterboxRecord> records(int petId, time_t from, time_t to) const;
+
+    size_t totalRecords(time_t from, time_t to) const;
+
+private:
+    std::vector<int> _petIds;
+    std::map<int, std::vector<LitterboxRecord>> _records;
+};
+
+#endif
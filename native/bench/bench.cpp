@@ -0,0 +1,257 @@
+// Storage and render benchmark. For each history length, generates a
+// workload, backfills it through DataManager, replays a run of two-hourly
+// wakes, then loads and renders every date range. Each step is reported as
+// one CSV row (or JSON line) on stdout; logs go to stderr.
+//
+//   pio run -e native_bench
+//   .pio/build/native_bench/program days=7,30,90,365,730 pets=4 visits=5 > bench.csv
+//
+// Options: days, pets, visits, wakes, seed, dir (scratch card directory),
+// format=csv|json, suite=history|primitives|codec|containers
+//
+// suite=primitives times FrameCanvas's drawing primitives instead (see
+// Primitives.h), in the layout of the EPD_SELECT it was built for.
+// suite=codec compares HistoryCodec blocks with the old JSON history for
+// each of the days (see Codec.h), and suite=containers PetSeries with the
+// nested std::map it replaced (see Containers.h):
+//   .pio/build/native_bench/program suite=containers days=365 pets=4
+
+#include <Arduino.h>
+#include <FS.h>
+#include <NativeHeap.h>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../../src/config.h"
+#include "../../src/Clock.h"
+#include "../../src/DataManager.h"
+#include "../../src/PlotManager.h"
+#include "Codec.h"
+#include "Containers.h"
+#include "Primitives.h"
+#include "Workload.h"
+
+static const DateRangeInfo ranges[] = {
+    {LAST_7_DAYS, "Last 7 Days", 7 * 86400L, false},
+    {LAST_30_DAYS, "Last 30 Days", 30 * 86400L, false},
+    {LAST_90_DAYS, "Last 90 Days", 90 * 86400L, true},
+    {LAST_365_DAYS, "Last 365 Days", 365 * 86400L, true},
+};
+
+// 2025-06-15 12:00 UTC
+static const time_t BACKFILL_END = 1749988800;
+static const time_t WAKE_SECONDS = 2 * 3600;
+
+struct Options
+{
+    std::vector<int> days = {7, 30, 90, 365, 730};
+    WorkloadConfig workload;
+    int wakes = 12;
+    std::string dir = "bench_out";
+    bool json = false;
+    std::string suite = "history";
+};
+
+struct Run
+{
+    const Options &options;
+    fs::FS &card;
+    int days;
+    size_t records;
+};
+
+static void emitHeader(const Options &options)
+{
+    if (!options.json)
+        printf("days,pets,records,stage,range,calls,ms,peak_heap,heap_growth,bytes_written,bytes_read,files_opened\n");
+}
+
+// Runs f once, then reports its wall time, the most heap live at once while
+// it ran, and the card traffic it caused
+template <typename F>
+static void measure(Run &run, const char *stage, const char *range, int calls, F f)
+{
+    run.card.resetStats();
+    NativeHeap::resetPeak();
+    size_t heapStart = NativeHeap::current();
+    auto start = std::chrono::steady_clock::now();
+    f();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    size_t peak = NativeHeap::peak();
+    const fs::FS::Stats &io = run.card.stats();
+
+    if (run.options.json)
+        printf("{\"days\":%d,\"pets\":%d,\"records\":%zu,\"stage\":\"%s\",\"range\":\"%s\",\"calls\":%d,\"ms\":%.3f,"
+               "\"peak_heap\":%zu,\"heap_growth\":%zu,\"bytes_written\":%llu,\"bytes_read\":%llu,\"files_opened\":%u}\n",
+               run.days, run.options.workload.pets, run.records, stage, range, calls, ms, peak, peak - heapStart,
+               (unsigned long long)io.bytesWritten, (unsigned long long)io.bytesRead, io.opens);
+    else
+        printf("%d,%d,%zu,%s,%s,%d,%.3f,%zu,%zu,%llu,%llu,%u\n", run.days, run.options.workload.pets, run.records, stage,
+               range, calls, ms, peak, peak - heapStart, (unsigned long long)io.bytesWritten,
+               (unsigned long long)io.bytesRead, io.opens);
+    fflush(stdout);
+}
+
+static void runHistory(const Options &options, int days)
+{
+    std::string root = options.dir + "/" + std::to_string(days);
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    fs::FS card(root);
+
+    WorkloadConfig config = options.workload;
+    config.days = days;
+    Workload workload(config, BACKFILL_END);
+    time_t backfillStart = BACKFILL_END - (time_t)days * 86400;
+    Run run = {options, card, days, workload.totalRecords(backfillStart, BACKFILL_END)};
+
+    std::vector<Pet> pets;
+    for (size_t p = 0; p < workload.petIds().size(); p++)
+        pets.push_back({workload.petIds()[p], String("Pet ") + String((int)p + 1)});
+
+    // Backfill, as the first fetch after setup
+    Clock::setFake(BACKFILL_END);
+    {
+        DataManager dataManager;
+        dataManager.begin(card);
+        PetDataMap petData;
+        dataManager.loadData(petData, backfillStart);
+        measure(run, "merge", "", pets.size(), [&] {
+            for (const Pet &pet : pets)
+                dataManager.mergeData(petData, pet.id, workload.records(pet.id, backfillStart, BACKFILL_END));
+        });
+        measure(run, "save", "", 1, [&] { dataManager.saveData(); });
+    }
+
+    // Regular wakes: what is new since the last one, loaded, merged and saved
+    time_t now = BACKFILL_END;
+    measure(run, "wake", "", options.wakes, [&] {
+        for (int w = 0; w < options.wakes; w++)
+        {
+            time_t last = now;
+            now += WAKE_SECONDS;
+            Clock::setFake(now);
+            DataManager dataManager;
+            dataManager.begin(card);
+            time_t latest = dataManager.getLatestTimestamp();
+            PetDataMap petData;
+            dataManager.loadData(petData, latest - 86400);
+            size_t added = 0;
+            for (const Pet &pet : pets)
+                added += dataManager.mergeData(petData, pet.id, workload.records(pet.id, last, now));
+            if (added > 0)
+                dataManager.saveData();
+        }
+    });
+
+    measure(run, "load_all", "", 1, [&] {
+        DataManager dataManager;
+        dataManager.begin(card);
+        PetDataMap petData;
+        dataManager.loadData(petData, now - (time_t)days * 86400);
+    });
+
+    GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> display(GxEPD2_DRIVER_CLASS(EPD_CS_PIN, EPD_DC_PIN, EPD_RES_PIN, EPD_BUSY_PIN));
+    PlotManager plotManager(&display);
+    StatusRecord status = {false, "Bench", "T4", 72, false, now};
+    for (const DateRangeInfo &range : ranges)
+    {
+        DataManager dataManager;
+        dataManager.begin(card);
+        PetDataMap petData;
+        PetRollupMap rollups;
+        // As main.cpp loads for a view wake
+        measure(run, "load", range.name, 1, [&] {
+            if (range.daily)
+                dataManager.loadRollups(rollups, now - range.seconds);
+            else
+                dataManager.loadData(petData, now - range.seconds);
+        });
+        measure(run, "render", range.name, 1, [&] {
+            plotManager.renderDashboard(pets, petData, rollups, range, status, true, 21.5, 40.0);
+        });
+    }
+}
+
+static std::vector<int> parseList(const std::string &value)
+{
+    std::vector<int> list;
+    for (size_t pos = 0; pos < value.size();)
+    {
+        size_t comma = value.find(',', pos);
+        if (comma == std::string::npos)
+            comma = value.size();
+        list.push_back(atoi(value.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return list;
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string key = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+        if (key == "days")
+            options.days = parseList(value);
+        else if (key == "pets")
+            options.workload.pets = atoi(value.c_str());
+        else if (key == "visits")
+            options.workload.visitsPerDay = atof(value.c_str());
+        else if (key == "wakes")
+            options.wakes = atoi(value.c_str());
+        else if (key == "seed")
+            options.workload.seed = strtoul(value.c_str(), nullptr, 10);
+        else if (key == "dir")
+            options.dir = value;
+        else if (key == "format")
+            options.json = value == "json";
+        else if (key == "suite" &&
+                 (value == "history" || value == "primitives" || value == "codec" || value == "containers"))
+            options.suite = value;
+        else
+        {
+            fprintf(stderr, "Unknown option %s\n", arg.c_str());
+            return 1;
+        }
+    }
+
+    if (options.suite == "primitives")
+        return runPrimitives(options.workload.seed, options.json) ? 0 : 1;
+    if (options.suite == "codec")
+        return runCodec(options.workload, options.days, BACKFILL_END, options.json) ? 0 : 1;
+    if (options.suite == "containers")
+        return runContainers(options.workload, options.days, options.wakes, BACKFILL_END, options.json) ? 0 : 1;
+
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    emitHeader(options);
+
+    // Each history length in its own process, so it starts with an empty
+    // RTC cache as after a power-on
+    for (int days : options.days)
+    {
+        // Or the child prints whatever is still buffered a second time
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            runHistory(options, days);
+            _exit(0);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "Run for %d days failed (status %d)\n", days, status);
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,6 @@
+#ifndef NATIVE_ADAFRUIT_I2CDEVICE_H
+#define NATIVE_ADAFRUIT_I2CDEVICE_H
+
+// Adafruit_GFX.h includes this BusIO header; nothing in it is used on the host.
+
+#endif
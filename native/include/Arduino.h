@@ -0,0 +1,71 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino core used by the code built in
+// the native environments. Hardware calls are no-ops or fixed readings.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <cmath>
+
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+#include <esp_heap_caps.h>
+
+#define PROGMEM
+#define PI 3.1415926535897932384626433832795
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RTC_DATA_ATTR
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+using std::abs;
+using std::max;
+using std::min;
+using ::round;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+
+// From the core's stdlib_noniso
+char *itoa(int value, char *str, int base);
+char *dtostrf(double value, signed char width, unsigned char prec, char *str);
+
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return HIGH; }
+
+// Battery divider reading; the harness can change it to exercise the status bar
+extern int nativeBatteryMilliVolts;
+inline uint32_t analogReadMilliVolts(uint8_t) { return nativeBatteryMilliVolts; }
+
+// Serial goes to stdout
+// Log output goes to stderr, leaving stdout to the harnesses
+class HostSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    size_t write(uint8_t c) override { return fputc(c, stderr) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buffer, size_t size) override { return fwrite(buffer, 1, size, stderr); }
+    using Print::write;
+    int available() override { return 0; }
+    int read() override { return -1; }
+    int peek() override { return -1; }
+};
+extern HostSerial Serial;
+
+inline size_t Print::print(const String &s) { return write(s.c_str()); }
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef NATIVE_FS_H
+#define NATIVE_FS_H
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+    enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+    class FileImpl;
+
+    // Handle to a file or directory on the host. Copies share one handle, as on the device.
+    class File : public Stream {
+    public:
+        File() {}
+        explicit File(std::shared_ptr<FileImpl> impl) : _impl(impl) {}
+
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t *buf, size_t size) override;
+        using Print::write;
+        int available() override;
+        int read() override;
+        int peek() override;
+        void flush() override;
+        size_t read(uint8_t *buf, size_t size);
+        size_t readBytes(char *buffer, size_t length) override { return read((uint8_t *)buffer, length); }
+        bool seek(uint32_t pos, SeekMode mode = SeekSet);
+        size_t position() const;
+        size_t size() const;
+        void close();
+        operator bool() const;
+        const char *path() const;
+        const char *name() const;
+        bool isDirectory() const;
+        File openNextFile(const char *mode = FILE_READ);
+
+    private:
+        std::shared_ptr<FileImpl> _impl;
+    };
+
+    // A directory of the host file system standing in for the card's root
+    class FS {
+    public:
+        explicit FS(const std::string &root = ".") : _root(root) {}
+
+        File open(const char *path, const char *mode = FILE_READ, bool create = false);
+        File open(const String &path, const char *mode = FILE_READ, bool create = false) { return open(path.c_str(), mode, create); }
+        bool exists(const char *path);
+        bool exists(const String &path) { return exists(path.c_str()); }
+        bool remove(const char *path);
+        bool remove(const String &path) { return remove(path.c_str()); }
+        bool rename(const char *from, const char *to);
+        bool rename(const String &from, const String &to) { return rename(from.c_str(), to.c_str()); }
+        bool mkdir(const char *path);
+        bool mkdir(const String &path) { return mkdir(path.c_str()); }
+        bool rmdir(const char *path);
+        bool rmdir(const String &path) { return rmdir(path.c_str()); }
+
+        void setRoot(const std::string &root) { _root = root; }
+        std::string hostPath(const char *path) const;
+
+        // I/O through this FS since construction or the last reset
+        struct Stats {
+            uint64_t bytesRead = 0;
+            uint64_t bytesWritten = 0;
+            uint32_t opens = 0;
+            uint32_t removes = 0;
+            uint32_t renames = 0;
+        };
+        Stats &stats() { return _stats; }
+        void resetStats() { _stats = Stats(); }
+
+    private:
+        std::string _root;
+        Stats _stats;
+    };
+
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef NATIVE_GXEPD2_H
+#define NATIVE_GXEPD2_H
+
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <algorithm>
+#include <vector>
+
+// Color values as defined by GxEPD2
+#define GxEPD_BLACK 0x0000
+#define GxEPD_DARKGREY 0x7BEF
+#define GxEPD_LIGHTGREY 0xC618
+#define GxEPD_WHITE 0xFFFF
+#define GxEPD_RED 0xF800
+#define GxEPD_YELLOW 0xFFE0
+#define GxEPD_COLORED GxEPD_RED
+#define GxEPD_BLUE 0x001F
+#define GxEPD_GREEN 0x07E0
+#define GxEPD_ORANGE 0xFC00
+
+/**
+ * @brief Stand-in for a GxEPD2 panel driver.
+ *
+ * Models the controller's RAM apart from what the panel shows in `frame`,
+ * both in the buffer format the driver is sent (1 bit per pixel set =
+ * white, or 4 bits per pixel GxEPD2_7C codes), and counts the transfers and
+ * refreshes. The B&W controller keeps the previous image next to the
+ * current one and a fast partial refresh only drives the pixels where they
+ * differ. As in GxEPD2, init() with initial set has the first write clear
+ * the whole RAM and turns the first windowed refresh into a full one, and
+ * hibernate() loses the RAM unless the panel keeps it through deep sleep.
+ */
+class MockEpd {
+public:
+    MockEpd(int16_t width, int16_t height, int bitsPerPixel, bool ramKeptInHibernate)
+        : width(width), height(height), bitsPerPixel(bitsPerPixel), ramKeptInHibernate(ramKeptInHibernate),
+          frame(planeSize(), blank()), current(planeSize(), blank()), previous(planeSize(), blank()) {}
+
+    void selectSPI(...) {}
+    void init(uint32_t = 0, bool initial = true) {
+        initialWrite = initial;
+        initialRefresh = initial;
+    }
+    void hibernate() {
+        hibernateCount++;
+        if (!ramKeptInHibernate) {
+            // Anything but the blank the driver would clear it to
+            std::fill(current.begin(), current.end(), 0x00);
+            std::fill(previous.begin(), previous.end(), 0x00);
+        }
+    }
+
+    void writeScreenBuffer() {
+        std::fill(current.begin(), current.end(), blank());
+        std::fill(previous.begin(), previous.end(), blank());
+        bytesWritten += 2 * planeSize();
+        initialWrite = false;
+    }
+
+    void writeImage(const uint8_t *bitmap, int16_t x, int16_t y, int16_t w, int16_t h,
+                    bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyRect(current, bitmap, x, y, w, h, invert);
+    }
+    void writeImageForFullRefresh(const uint8_t *bitmap, int16_t x, int16_t y, int16_t w, int16_t h,
+                                  bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyRect(previous, bitmap, x, y, w, h, invert);
+        copyRect(current, bitmap, x, y, w, h, invert);
+    }
+    // To the image the controller diffs a partial refresh against only
+    void writeImagePrevious(const uint8_t *bitmap, int16_t x, int16_t y, int16_t w, int16_t h,
+                            bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyRect(previous, bitmap, x, y, w, h, invert);
+    }
+    void writeImageAgain(const uint8_t *bitmap, int16_t x, int16_t y, int16_t w, int16_t h,
+                         bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyRect(previous, bitmap, x, y, w, h, invert);
+        copyRect(current, bitmap, x, y, w, h, invert);
+    }
+    void writeNative(const uint8_t *data1, const uint8_t *data2, int16_t x, int16_t y, int16_t w, int16_t h,
+                     bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyRect(current, data1, x, y, w, h, invert);
+    }
+    // The w by h window at x_part, y_part of a w_bitmap wide bitmap, to x, y
+    void writeImagePart(const uint8_t *bitmap, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                        int16_t x, int16_t y, int16_t w, int16_t h,
+                        bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyPart(current, bitmap, x_part, y_part, w_bitmap, x, y, w, h, invert);
+    }
+    void writeImagePartAgain(const uint8_t *bitmap, int16_t x_part, int16_t y_part, int16_t w_bitmap, int16_t h_bitmap,
+                             int16_t x, int16_t y, int16_t w, int16_t h,
+                             bool invert = false, bool mirror_y = false, bool pgm = false) {
+        copyPart(previous, bitmap, x_part, y_part, w_bitmap, x, y, w, h, invert);
+        copyPart(current, bitmap, x_part, y_part, w_bitmap, x, y, w, h, invert);
+    }
+
+    void refresh(bool partial_update_mode = false) {
+        if (partial_update_mode && !initialRefresh && bitsPerPixel == 1) {
+            refresh(0, 0, width, height);
+            return;
+        }
+        frame = current;
+        fullRefreshCount++;
+        initialRefresh = false;
+    }
+    void refresh(int16_t x, int16_t y, int16_t w, int16_t h) {
+        if (initialRefresh || bitsPerPixel != 1) {
+            refresh(false);
+            return;
+        }
+        // Pixels where the previous and current image agree are not driven
+        size_t stride = (size_t)width / 8;
+        for (int16_t row = y; row < y + h && row < height; row++) {
+            for (size_t i = (size_t)x / 8; i < (size_t)(x + w) / 8 && i < stride; i++) {
+                size_t at = (size_t)row * stride + i;
+                uint8_t driven = previous[at] ^ current[at];
+                frame[at] = (frame[at] & ~driven) | (current[at] & driven);
+            }
+        }
+        partialRefreshCount++;
+    }
+
+    const int16_t width, height;
+    const int bitsPerPixel;
+    const bool ramKeptInHibernate;
+    std::vector<uint8_t> frame;
+    uint32_t bytesWritten = 0;
+    uint32_t fullRefreshCount = 0;
+    uint32_t partialRefreshCount = 0;
+    uint32_t hibernateCount = 0;
+
+private:
+    std::vector<uint8_t> current;  // the controller's new image RAM
+    std::vector<uint8_t> previous; // and its old one, B&W only
+    bool initialWrite = true;
+    bool initialRefresh = true;
+
+    size_t planeSize() const { return (size_t)width * height * bitsPerPixel / 8; }
+    uint8_t blank() const { return bitsPerPixel == 1 ? 0xFF : 0x11; }
+
+    // Rows of w pixels at x, y; x and w must fall on byte boundaries
+    void copyRect(std::vector<uint8_t> &ram, const uint8_t *data, int16_t x, int16_t y, int16_t w, int16_t h, bool invert) {
+        if (initialWrite)
+            writeScreenBuffer();
+        size_t rowBytes = (size_t)w * bitsPerPixel / 8;
+        size_t stride = (size_t)width * bitsPerPixel / 8;
+        size_t offset = (size_t)x * bitsPerPixel / 8;
+        for (int16_t row = 0; row < h; row++) {
+            if (y + row < 0 || y + row >= height) continue;
+            uint8_t *dest = ram.data() + (size_t)(y + row) * stride + offset;
+            const uint8_t *src = data + (size_t)row * rowBytes;
+            for (size_t i = 0; i < rowBytes && offset + i < stride; i++) {
+                dest[i] = invert ? ~src[i] : src[i];
+            }
+        }
+        bytesWritten += rowBytes * h;
+    }
+
+    // Same for a window of a larger bitmap; x_part, x and w on byte boundaries
+    void copyPart(std::vector<uint8_t> &ram, const uint8_t *data, int16_t x_part, int16_t y_part, int16_t w_bitmap,
+                  int16_t x, int16_t y, int16_t w, int16_t h, bool invert) {
+        if (initialWrite)
+            writeScreenBuffer();
+        size_t rowBytes = (size_t)w * bitsPerPixel / 8;
+        size_t srcStride = (size_t)w_bitmap * bitsPerPixel / 8;
+        size_t stride = (size_t)width * bitsPerPixel / 8;
+        for (int16_t row = 0; row < h; row++) {
+            if (y + row < 0 || y + row >= height) continue;
+            uint8_t *dest = ram.data() + (size_t)(y + row) * stride + (size_t)x * bitsPerPixel / 8;
+            const uint8_t *src = data + (size_t)(y_part + row) * srcStride + (size_t)x_part * bitsPerPixel / 8;
+            for (size_t i = 0; i < rowBytes; i++) {
+                dest[i] = invert ? ~src[i] : src[i];
+            }
+        }
+        bytesWritten += rowBytes * h;
+    }
+};
+
+// The two panels of the reTerminal E1001/E1002
+class GxEPD2_750_GDEY075T7 : public MockEpd {
+public:
+    static const uint16_t WIDTH = 800;
+    static const uint16_t HEIGHT = 480;
+    static const bool hasPartialUpdate = true;
+    static const bool hasFastPartialUpdate = true;
+    // The UC8179 loses its RAM in deep sleep
+    GxEPD2_750_GDEY075T7(int16_t cs, int16_t dc, int16_t rst, int16_t busy) : MockEpd(WIDTH, HEIGHT, 1, false) {}
+};
+
+class GxEPD2_730c_GDEP073E01 : public MockEpd {
+public:
+    static const uint16_t WIDTH = 800;
+    static const uint16_t HEIGHT = 480;
+    static const bool hasPartialUpdate = false;
+    static const bool hasFastPartialUpdate = false;
+    GxEPD2_730c_GDEP073E01(int16_t cs, int16_t dc, int16_t rst, int16_t busy) : MockEpd(WIDTH, HEIGHT, 4, false) {}
+};
+
+// GxEPD2_BW / GxEPD2_7C: only the driver member is used by the rendering code
+template <typename GxEPD2_Type, const uint16_t page_height>
+class GxEPD2_MockDisplay {
+public:
+    explicit GxEPD2_MockDisplay(GxEPD2_Type epd2_instance) : epd2(epd2_instance) {}
+    void init(uint32_t bitrate = 0, bool initial = true) { epd2.init(bitrate, initial); }
+    void hibernate() { epd2.hibernate(); }
+    GxEPD2_Type epd2;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef NATIVE_GXEPD2_7C_H
+#define NATIVE_GXEPD2_7C_H
+
+#include "GxEPD2.h"
+
+template <typename GxEPD2_Type, const uint16_t page_height>
+using GxEPD2_7C = GxEPD2_MockDisplay<GxEPD2_Type, page_height>;
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef NATIVE_HEAP_H
+#define NATIVE_HEAP_H
+
+#include <stddef.h>
+
+// Accounting for everything the host builds allocate, through operator new
+// or heap_caps_malloc, so the harnesses can report what a step would need
+// on the device. Counts requested bytes, without allocator overhead.
+namespace NativeHeap {
+
+    void *allocate(size_t size);
+    // As realloc(), for a block from allocate()
+    void *reallocate(void *ptr, size_t size);
+    void release(void *ptr);
+
+    // Bytes live right now
+    size_t current();
+
+    // Most bytes live at once since the last resetPeak()
+    size_t peak();
+    void resetPeak();
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef NATIVE_PETKIT_API_H
+#define NATIVE_PETKIT_API_H
+
+#include <Arduino.h>
+
+// Record types of PetkitAPI_Arduino, without the HTTP client behind them
+
+struct LitterboxRecord {
+    time_t timestamp;
+    int pet_id;
+    int weight_grams;
+    int duration_seconds;
+};
+
+struct StatusRecord {
+    bool box_full;
+    String device_name;
+    String device_type;
+    int litter_percent;
+    bool sand_lack;
+    time_t timestamp;
+};
+
+struct Pet {
+    int id;
+    String name;
+};
+
+#endif
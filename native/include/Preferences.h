@@ -0,0 +1,54 @@
+#ifndef NATIVE_PREFERENCES_H
+#define NATIVE_PREFERENCES_H
+
+#include <Arduino.h>
+#include <map>
+#include <string>
+#include <vector>
+
+// NVS stand-in: every namespace lives in process memory for the length of a
+// run, shared between Preferences instances as on the device.
+class Preferences {
+public:
+    bool begin(const char *name, bool readOnly = false);
+    void end();
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putInt(const char *key, int32_t value) { return putValue(key, value); }
+    size_t putUInt(const char *key, uint32_t value) { return putValue(key, value); }
+    size_t putBool(const char *key, bool value) { return putValue(key, (uint8_t)value); }
+    size_t putULong64(const char *key, uint64_t value) { return putValue(key, value); }
+    size_t putString(const char *key, const char *value) { return putBytes(key, value, strlen(value) + 1); }
+    size_t putString(const char *key, const String &value) { return putString(key, value.c_str()); }
+    size_t putBytes(const char *key, const void *value, size_t len);
+
+    int32_t getInt(const char *key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    bool getBool(const char *key, bool defaultValue = false) { return getValue(key, (uint8_t)defaultValue); }
+    uint64_t getULong64(const char *key, uint64_t defaultValue = 0) { return getValue(key, defaultValue); }
+    String getString(const char *key, const String &defaultValue = String());
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+    // Drop every namespace, as after erasing the flash
+    static void eraseAll();
+
+private:
+    typedef std::map<std::string, std::vector<uint8_t>> Namespace;
+
+    Namespace *_ns = nullptr;
+    bool _readOnly = false;
+
+    template <typename T>
+    size_t putValue(const char *key, T value) { return putBytes(key, &value, sizeof(value)); }
+
+    template <typename T>
+    T getValue(const char *key, T defaultValue) {
+        T value;
+        return getBytesLength(key) == sizeof(T) && getBytes(key, &value, sizeof(T)) ? value : defaultValue;
+    }
+};
+
+#endif
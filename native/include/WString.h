@@ -0,0 +1,67 @@
+#ifndef NATIVE_WSTRING_H
+#define NATIVE_WSTRING_H
+
+#include <string>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Arduino String on top of std::string, covering what this project uses
+class String {
+public:
+    String(const char *s = "") : _s(s ? s : "") {}
+    String(const std::string &s) : _s(s) {}
+    explicit String(char c) : _s(1, c) {}
+    explicit String(int n) : _s(std::to_string(n)) {}
+    explicit String(unsigned int n) : _s(std::to_string(n)) {}
+    explicit String(long n) : _s(std::to_string(n)) {}
+    explicit String(unsigned long n) : _s(std::to_string(n)) {}
+    explicit String(double n, unsigned int digits = 2) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.*f", digits, n);
+        _s = buf;
+    }
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.length(); }
+    bool isEmpty() const { return _s.empty(); }
+    bool reserve(unsigned int size) { _s.reserve(size); return true; }
+
+    bool concat(const String &s) { _s += s._s; return true; }
+    bool concat(const char *s) { if (s) _s += s; return true; }
+    bool concat(const char *s, unsigned int n) { if (s) _s.append(s, n); return true; }
+    bool concat(char c) { _s += c; return true; }
+    String &operator+=(const String &s) { concat(s); return *this; }
+    String &operator+=(const char *s) { concat(s); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+
+    bool operator==(const String &s) const { return _s == s._s; }
+    bool operator==(const char *s) const { return _s == (s ? s : ""); }
+    bool operator!=(const String &s) const { return _s != s._s; }
+    bool operator!=(const char *s) const { return !(*this == s); }
+    bool operator<(const String &s) const { return _s < s._s; }
+    char operator[](unsigned int i) const { return i < _s.length() ? _s[i] : 0; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t i = _s.find(c, from);
+        return i == std::string::npos ? -1 : (int)i;
+    }
+    String substring(unsigned int from, unsigned int to = (unsigned int)-1) const {
+        if (from > _s.length()) return String();
+        return String(_s.substr(from, to == (unsigned int)-1 ? std::string::npos : to - from));
+    }
+    bool startsWith(const String &s) const { return _s.compare(0, s._s.length(), s._s) == 0; }
+    bool endsWith(const String &s) const {
+        return _s.length() >= s._s.length() && _s.compare(_s.length() - s._s.length(), s._s.length(), s._s) == 0;
+    }
+    long toInt() const { return atol(_s.c_str()); }
+
+    friend String operator+(const String &a, const String &b) { return String(a._s + b._s); }
+    friend String operator+(const String &a, const char *b) { return String(a._s + (b ? b : "")); }
+    friend String operator+(const char *a, const String &b) { return String((a ? a : "") + b._s); }
+
+private:
+    std::string _s;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <NativeHeap.h>
+
+// No PSRAM on the host: every capability comes from the normal heap
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_8BIT (1 << 2)
+
+inline void *heap_caps_malloc(size_t size, uint32_t) { return NativeHeap::allocate(size); }
+inline void heap_caps_free(void *ptr) { NativeHeap::release(ptr); }
+
+// One pool the size of the board's PSRAM stands in for every capability
+static const size_t NATIVE_HEAP_TOTAL = 8 * 1024 * 1024;
+inline size_t heap_caps_get_total_size(uint32_t) { return NATIVE_HEAP_TOTAL; }
+inline size_t heap_caps_get_free_size(uint32_t) { return NATIVE_HEAP_TOTAL - NativeHeap::current(); }
+inline size_t heap_caps_get_minimum_free_size(uint32_t) { return NATIVE_HEAP_TOTAL - NativeHeap::peak(); }
+
+#endif
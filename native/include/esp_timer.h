@@ -0,0 +1,9 @@
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include <Arduino.h>
+
+// Microseconds since the program started
+inline int64_t esp_timer_get_time() { return micros(); }
+
+#endif
@@ -0,0 +1,121 @@
+#include "ImageWriter.h"
+#include "../../src/Crc32.h"
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+// GxEPD2_7C codes 0..6 as seen on the panel
+static const uint8_t PALETTE_7C[7][3] = {
+    {0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF}, {0x00, 0x80, 0x00}, {0x00, 0x00, 0xFF},
+    {0xFF, 0x00, 0x00}, {0xFF, 0xFF, 0x00}, {0xFF, 0x80, 0x00}};
+static const uint8_t PALETTE_BW[2][3] = {{0x00, 0x00, 0x00}, {0xFF, 0xFF, 0xFF}};
+
+static void putBE32(std::vector<uint8_t> &out, uint32_t v)
+{
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+static void writeChunk(FILE *f, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> chunk;
+    putBE32(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+bool writePbm(const char *path, const uint8_t *frame, int width, int height, int bitsPerPixel)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return false;
+    fprintf(f, "P4\n%d %d\n", width, height);
+    std::vector<uint8_t> row(width / 8);
+    for (int y = 0; y < height; y++)
+    {
+        for (int bx = 0; bx < width / 8; bx++)
+        {
+            uint8_t bits = 0;
+            for (int b = 0; b < 8; b++)
+            {
+                size_t x = (size_t)y * width + bx * 8 + b;
+                bool white = bitsPerPixel == 1 ? (frame[x / 8] >> (7 - x % 8)) & 1
+                                               : ((frame[x / 2] >> (x & 1 ? 0 : 4)) & 0x0F) == 0x01;
+                // PBM has 1 = black
+                if (!white)
+                    bits |= 0x80 >> b;
+            }
+            row[bx] = bits;
+        }
+        fwrite(row.data(), 1, row.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+bool writePng(const char *path, const uint8_t *frame, int width, int height, int bitsPerPixel)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+        return false;
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    fwrite(signature, 1, sizeof(signature), f);
+
+    // The buffers are already packed MSB first, which is how PNG packs palette indices
+    std::vector<uint8_t> ihdr;
+    putBE32(ihdr, width);
+    putBE32(ihdr, height);
+    ihdr.push_back(bitsPerPixel);
+    ihdr.push_back(3); // palette
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    writeChunk(f, "IHDR", ihdr);
+
+    std::vector<uint8_t> plte;
+    int colors = bitsPerPixel == 1 ? 2 : 7;
+    for (int i = 0; i < colors; i++)
+        plte.insert(plte.end(), bitsPerPixel == 1 ? PALETTE_BW[i] : PALETTE_7C[i],
+                    (bitsPerPixel == 1 ? PALETTE_BW[i] : PALETTE_7C[i]) + 3);
+    writeChunk(f, "PLTE", plte);
+
+    // Raw scanlines, each led by filter type 0
+    size_t stride = (size_t)width * bitsPerPixel / 8;
+    std::vector<uint8_t> raw;
+    raw.reserve((stride + 1) * height);
+    for (int y = 0; y < height; y++)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), frame + y * stride, frame + (y + 1) * stride);
+    }
+
+    // zlib stream of stored blocks, at most 65535 bytes each
+    std::vector<uint8_t> idat = {0x78, 0x01};
+    for (size_t pos = 0; pos < raw.size() || pos == 0;)
+    {
+        size_t len = std::min<size_t>(raw.size() - pos, 65535);
+        bool last = pos + len == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(len & 0xFF);
+        idat.push_back(len >> 8);
+        idat.push_back(~len & 0xFF);
+        idat.push_back((~len >> 8) & 0xFF);
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+        if (last)
+            break;
+    }
+    uint32_t a = 1, b = 0;
+    for (uint8_t c : raw)
+    {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE32(idat, (b << 16) | a);
+    writeChunk(f, "IDAT", idat);
+    writeChunk(f, "IEND", {});
+    return fclose(f) == 0;
+}
@@ -0,0 +1,17 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Writers for panel-native frame buffers, used by the render harness.
+// bitsPerPixel is 1 for the E1001 format (set = white) or 4 for the
+// E1002 GxEPD2_7C color codes; width must be a multiple of 8.
+
+// Portable bitmap (P4). 4bpp frames are written as white / not white.
+bool writePbm(const char *path, const uint8_t *frame, int width, int height, int bitsPerPixel);
+
+// Palette PNG with stored (uncompressed) deflate blocks, so no zlib is needed
+bool writePng(const char *path, const uint8_t *frame, int width, int height, int bitsPerPixel);
+
+#endif
@@ -0,0 +1,294 @@
+// Host-side render harness: draws the dashboard for every date range from
+// synthetic history, times it, and writes the frames as PNG and PBM.
+//
+//   pio run -e native_1001 -t exec        (or native_1002)
+//   .pio/build/native_1001/program [output dir]
+
+#include <Arduino.h>
+#include <FS.h>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include "../../src/config.h"
+#include "../../src/PlotManager.h"
+#include "../../src/Clock.h"
+#include "ImageWriter.h"
+
+#if (EPD_SELECT == 1002)
+static const int BITS_PER_PIXEL = 4;
+#else
+static const int BITS_PER_PIXEL = 1;
+#endif
+
+static const DateRangeInfo ranges[] = {
+    {LAST_7_DAYS, "Last 7 Days", 7 * 86400L, false},
+    {LAST_30_DAYS, "Last 30 Days", 30 * 86400L, false},
+    {LAST_90_DAYS, "Last 90 Days", 90 * 86400L, true},
+    {LAST_365_DAYS, "Last 365 Days", 365 * 86400L, true},
+};
+
+static const uint16_t petColors[][2] = {
+    {EPD_RED, EPD_YELLOW}, {EPD_BLUE, EPD_BLACK}, {EPD_GREEN, EPD_YELLOW}, {EPD_BLACK, EPD_WHITE}};
+
+// Fixed-seed generator; with the clock pinned every run draws the same frames
+static uint32_t nextRandom()
+{
+    static uint32_t state = 0x2545F491;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// A year of visits for each pet: 3 to 7 a day, weights drifting around a
+// per-pet baseline, plus the per-UTC-day rollups DataManager would keep.
+static void buildHistory(std::vector<Pet> &pets, PetDataMap &data, PetRollupMap &rollups, time_t now)
+{
+    const char *names[] = {"Mochi", "Biscuit", "Pepper", "Luna"};
+    const int32_t baseWeights[] = {4200, 5600, 3300, 6100};
+    for (int p = 0; p < 4; p++)
+        pets.push_back({1000 + p, names[p]});
+
+    time_t start = (now - 365 * 86400L) / 86400 * 86400;
+    for (int p = 0; p < 4; p++)
+    {
+        PetSeries &series = data[pets[p].id];
+        int32_t drift = 0;
+        for (time_t day = start; day < now; day += 86400)
+        {
+            int visits = 3 + nextRandom() % 5;
+            drift += (int32_t)(nextRandom() % 41) - 20;
+            for (int v = 0; v < visits; v++)
+            {
+                time_t ts = day + (86400 / visits) * v + nextRandom() % (86400 / visits);
+                if (ts >= now)
+                    break;
+                series.insert(ts, baseWeights[p] + drift + (int32_t)(nextRandom() % 300) - 150, 60 + nextRandom() % 240);
+            }
+        }
+
+        PsramVector<DailyRollup> &days = rollups[pets[p].id].days;
+        for (size_t i = 0; i < series.size(); i++)
+        {
+            uint32_t dayIndex = series.timestamp(i) / 86400;
+            if (days.empty() || days.back().day != dayIndex)
+            {
+                DailyRollup day{};
+                day.day = dayIndex;
+                day.minWeight = INT32_MAX;
+                day.maxWeight = INT32_MIN;
+                days.push_back(day);
+            }
+            addVisit(days.back(), series.weight(i), series.duration(i),
+                     i > 0 ? (int64_t)(series.timestamp(i) - series.timestamp(i - 1)) : -1);
+        }
+    }
+}
+
+// Each pet's buckets over the days from since on, as DataManager::loadRollups
+// sums them for a daily range
+static void sumBuckets(const std::vector<Pet> &pets, const PetDataMap &data, PetRollupMap &rollups, time_t since)
+{
+    for (const Pet &pet : pets)
+    {
+        BucketCounts &buckets = rollups[pet.id].buckets;
+        buckets = {};
+        const PetSeries *series = data.find(pet.id);
+        for (size_t i = series->lowerBound(since / 86400 * 86400); i < series->size(); i++)
+            addVisit(buckets, series->duration(i), i > 0 ? (int64_t)(series->timestamp(i) - series->timestamp(i - 1)) : -1);
+    }
+}
+
+// The widget inputs PlotManager::drawPlots derives, for timing each widget alone
+struct WidgetInputs
+{
+    std::vector<std::vector<DataPoint>> scatter;
+    std::vector<std::vector<float>> intervals;
+    std::vector<std::vector<float>> durations;
+    // Daily ranges: the histograms' bucket counts and largest values instead
+    std::vector<std::vector<uint32_t>> intervalBuckets, durationBuckets;
+    std::vector<float> maxInterval, maxDuration;
+};
+
+static WidgetInputs collectInputs(const std::vector<Pet> &pets, const PetDataMap &data, const PetRollupMap &rollups,
+                                  const DateRangeInfo &range, time_t now)
+{
+    WidgetInputs in;
+    in.scatter.resize(pets.size());
+    in.intervals.resize(pets.size());
+    in.durations.resize(pets.size());
+    in.intervalBuckets.assign(pets.size(), std::vector<uint32_t>(ROLLUP_BUCKETS, 0));
+    in.durationBuckets.assign(pets.size(), std::vector<uint32_t>(ROLLUP_BUCKETS, 0));
+    in.maxInterval.assign(pets.size(), 0);
+    in.maxDuration.assign(pets.size(), 0);
+    time_t timeStart = now - range.seconds;
+    for (size_t p = 0; p < pets.size(); p++)
+    {
+        if (range.daily)
+        {
+            auto it = rollups.find(pets[p].id);
+            if (it == rollups.end())
+                continue;
+            for (int b = 0; b < ROLLUP_BUCKETS; b++)
+            {
+                in.intervalBuckets[p][b] = it->second.buckets.interval[b];
+                in.durationBuckets[p][b] = it->second.buckets.duration[b];
+            }
+            for (const DailyRollup &day : it->second.days)
+            {
+                if (day.day < timeStart / 86400 || day.visits == 0)
+                    continue;
+                in.scatter[p].push_back({(int32_t)((time_t)day.day * 86400L + 43200 - timeStart), (float)(day.sumWeight / day.visits / GRAMS_PER_POUND)});
+                in.maxDuration[p] = std::max(in.maxDuration[p], day.maxDuration / 60.0f);
+                if (day.intervals > 0)
+                    in.maxInterval[p] = std::max(in.maxInterval[p], day.maxInterval / 3600.0f);
+            }
+            continue;
+        }
+        const PetSeries *series = data.find(pets[p].id);
+        if (series == nullptr)
+            continue;
+        for (size_t i = series->lowerBound(timeStart); i < series->size(); i++)
+        {
+            in.scatter[p].push_back({(int32_t)(series->timestamp(i) - timeStart), (float)(series->weight(i) / GRAMS_PER_POUND)});
+            in.durations[p].push_back((float)series->duration(i) / 60.0);
+            if (i > series->lowerBound(timeStart))
+                in.intervals[p].push_back((float)(series->timestamp(i) - series->timestamp(i - 1)) / 3600.0);
+        }
+    }
+    return in;
+}
+
+static double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void printRow(const char *range, const char *widget, double ms, uint32_t pixels)
+{
+    printf("%-14s %-18s %10.2f %12u\n", range, widget, ms, pixels);
+}
+
+int main(int argc, char **argv)
+{
+    std::string outDir = argc > 1 ? argv[1] : "render_out";
+    mkdir(outDir.c_str(), 0755);
+
+    // 2025-06-15 12:00 UTC, drawn in UTC
+    Clock::setFake(1749988800);
+    setenv("TZ", "UTC0", 1);
+    tzset();
+
+    time_t now = Clock::now();
+    std::vector<Pet> pets;
+    PetDataMap data;
+    PetRollupMap rollups;
+    buildHistory(pets, data, rollups, now);
+
+    StatusRecord status = {false, "Harness", "T4", 72, false, now};
+    GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> display(GxEPD2_DRIVER_CLASS(EPD_CS_PIN, EPD_DC_PIN, EPD_RES_PIN, EPD_BUSY_PIN));
+    PlotManager plotManager(&display);
+
+    printf("%-14s %-18s %10s %12s\n", "range", "widget", "ms", "drawPixel");
+    for (const DateRangeInfo &range : ranges)
+    {
+        // Whole dashboard through the mock panel, as the firmware does it
+        if (range.daily)
+            sumBuckets(pets, data, rollups, now - range.seconds);
+        const_cast<FrameCanvas &>(plotManager.canvas()).resetStats();
+        auto start = std::chrono::steady_clock::now();
+        plotManager.renderDashboard(pets, data, rollups, range, status, true, 21.5, 40.0);
+        printRow(range.name, "dashboard", elapsedMs(start), plotManager.canvas().pixelCalls());
+        printf("%-14s %-18s %10s %12u bytes\n", range.name, "display list", "", (unsigned)plotManager.displayListBytes());
+        printf("%-14s %-18s %10s %12u bytes\n", range.name, "render arena", "", (unsigned)plotManager.renderArenaHighWater());
+
+        std::string base = outDir + "/" + std::to_string(EPD_SELECT) + "_range" + std::to_string((int)range.type);
+        if (!writePng((base + ".png").c_str(), display.epd2.frame.data(), EPD_WIDTH, EPD_HEIGHT, BITS_PER_PIXEL) ||
+            !writePbm((base + ".pbm").c_str(), display.epd2.frame.data(), EPD_WIDTH, EPD_HEIGHT, BITS_PER_PIXEL))
+            printf("Failed to write %s\n", base.c_str());
+
+        // Each widget on its own canvas, with the geometry drawPlots gives it
+        WidgetInputs in = collectInputs(pets, data, rollups, range, now);
+        FrameCanvas canvas(EPD_WIDTH, EPD_HEIGHT);
+
+        canvas.fillScreen(GxEPD_WHITE);
+        canvas.resetStats();
+        start = std::chrono::steady_clock::now();
+        Histogram histInterval(&canvas, 0, EPD_HEIGHT * 3 / 4, EPD_WIDTH / 2, EPD_HEIGHT / 4);
+        histInterval.setTitle("Interval (Hours)");
+        histInterval.setBinCount(16);
+        histInterval.setNormalization(true);
+        for (size_t p = 0; p < pets.size(); p++)
+        {
+            if (range.daily)
+                histInterval.addBucketedSeries(pets[p].name.c_str(), in.intervalBuckets[p], INTERVAL_BUCKET_SECONDS / 3600.0f,
+                                               in.maxInterval[p], petColors[p % 4][0], petColors[p % 4][1]);
+            else
+                histInterval.addSeries(pets[p].name.c_str(), in.intervals[p], petColors[p % 4][0], petColors[p % 4][1]);
+        }
+        histInterval.plot();
+        printRow(range.name, "interval histogram", elapsedMs(start), canvas.pixelCalls());
+
+        canvas.resetStats();
+        start = std::chrono::steady_clock::now();
+        Histogram histDuration(&canvas, EPD_WIDTH / 2, EPD_HEIGHT * 3 / 4, EPD_WIDTH / 2, EPD_HEIGHT / 4);
+        histDuration.setTitle("Duration (Minutes)");
+        histDuration.setBinCount(16);
+        histDuration.setNormalization(true);
+        for (size_t p = 0; p < pets.size(); p++)
+        {
+            if (range.daily)
+                histDuration.addBucketedSeries(pets[p].name.c_str(), in.durationBuckets[p], DURATION_BUCKET_SECONDS / 60.0f,
+                                               in.maxDuration[p], petColors[p % 4][0], petColors[p % 4][1]);
+            else
+                histDuration.addSeries(pets[p].name.c_str(), in.durations[p], petColors[p % 4][0], petColors[p % 4][1]);
+        }
+        histDuration.plot();
+        printRow(range.name, "duration histogram", elapsedMs(start), canvas.pixelCalls());
+
+        canvas.resetStats();
+        start = std::chrono::steady_clock::now();
+        ScatterPlot plot(&canvas, 0, 0, EPD_WIDTH, EPD_HEIGHT * 3 / 4);
+        plot.setLabels(range.name, "Date", "Weight(lb)");
+        plot.setTimeOrigin(now - range.seconds);
+        for (size_t p = 0; p < pets.size(); p++)
+            plot.addSeries(pets[p].name, in.scatter[p], petColors[p % 4][0], petColors[p % 4][1], range.type == LAST_7_DAYS ? 10 : 18, 10);
+        plot.draw();
+        printRow(range.name, "scatter plot", elapsedMs(start), canvas.pixelCalls());
+        printf("%-14s %-18s %10s %12u of %u points\n", range.name, "scatter markers", "", (unsigned)plot.markersDrawn(),
+               (unsigned)plot.pointCount());
+    }
+
+    printf("Panel: %u full refreshes, %u bytes written. Frames in %s/\n",
+           display.epd2.fullRefreshCount, display.epd2.bytesWritten, outDir.c_str());
+
+    // Timer wakes with nothing new, an hour apart: only the status bar changes
+    fs::FS card(outDir);
+    plotManager.setFrameCache(&card, 1, pets);
+    plotManager.renderDashboard(pets, data, rollups, ranges[0], status, true, 21.5, 40.0);
+    printf("\n%-6s %-12s %10s %6s %8s %s\n", "wake", "status", "bytes", "full", "partial", "panel matches frame");
+    for (int wake = 0; wake <= PARTIAL_REFRESH_LIMIT + 2; wake++)
+    {
+        // Each wake starts from a hibernated panel, as on the device
+        display.hibernate();
+        display.init(0, false);
+        Clock::setFake(now + wake * 3600L);
+        if (wake == 2)
+            status.litter_percent = 65;
+        uint32_t bytes = display.epd2.bytesWritten;
+        uint32_t full = display.epd2.fullRefreshCount;
+        uint32_t partial = display.epd2.partialRefreshCount;
+
+        PlotManager::StatusRefresh result = plotManager.refreshStatus(ranges[0], status);
+        if (result == PlotManager::STATUS_NEEDS_FRAME)
+            plotManager.showCachedFrame(ranges[0], status);
+
+        const char *names[] = {"unchanged", "partial", "full frame"};
+        const FrameCanvas &page = plotManager.canvas();
+        bool matches = memcmp(display.epd2.frame.data() + page.bandTop() * page.rowBytes(), page.buffer(), page.bufferSize()) == 0;
+        printf("%-6d %-12s %10u %6u %8u %s\n", wake, names[result], display.epd2.bytesWritten - bytes,
+               display.epd2.fullRefreshCount - full, display.epd2.partialRefreshCount - partial, matches ? "yes" : "NO");
+    }
+    return 0;
+}
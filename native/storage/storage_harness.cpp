@@ -0,0 +1,154 @@
+// Host-side storage harness: runs DataManager against a directory on the PC
+// with the clock pinned, backfilling a year of history and then replaying a
+// day of two-hourly wakes, and reports time per call and what ended up on disk.
+//
+//   pio run -e native_storage -t exec
+//   .pio/build/native_storage/program [card directory]
+
+#include <Arduino.h>
+#include <FS.h>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <string>
+#include "../../src/DataManager.h"
+#include "../../src/Clock.h"
+
+static const int PET_COUNT = 4;
+static const int WAKES = 12;
+static const time_t WAKE_SECONDS = 2 * 3600;
+
+static uint32_t nextRandom()
+{
+    static uint32_t state = 0x2545F491;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// Visits of one pet between from and to, a few hours apart
+static std::vector<LitterboxRecord> visits(int petId, time_t from, time_t to)
+{
+    std::vector<LitterboxRecord> records;
+    for (time_t ts = from + nextRandom() % 14400; ts < to; ts += 10800 + nextRandom() % 14400)
+        records.push_back({ts, petId, (int)(3500 + petId % 10 * 700 + nextRandom() % 300), (int)(60 + nextRandom() % 240)});
+    return records;
+}
+
+struct Timing
+{
+    uint32_t calls = 0;
+    double ms = 0;
+};
+static std::map<std::string, Timing> timings;
+
+// Adds the time until it goes out of scope to the named call
+struct Stopwatch
+{
+    const char *name;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ~Stopwatch()
+    {
+        Timing &t = timings[name];
+        t.calls++;
+        t.ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+};
+
+int main(int argc, char **argv)
+{
+    std::string root = argc > 1 ? argv[1] : "storage_out";
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root);
+    fs::FS card(root);
+
+    // 2025-06-15 12:00 UTC
+    time_t now = 1749988800;
+    Clock::setFake(now);
+
+    // First run: a year fetched at once, as after setting the device up
+    {
+        DataManager dataManager;
+        dataManager.begin(card);
+        PetDataMap petData;
+        {
+            Stopwatch t{"loadData"};
+            dataManager.loadData(petData, now - DATA_RETENTION_SECONDS);
+        }
+        for (int p = 0; p < PET_COUNT; p++)
+        {
+            std::vector<LitterboxRecord> records = visits(1000 + p, now - DATA_RETENTION_SECONDS, now);
+            Stopwatch t{"mergeData"};
+            dataManager.mergeData(petData, 1000 + p, records);
+        }
+        Stopwatch t{"saveData"};
+        dataManager.saveData();
+    }
+    printf("Backfill: %llu bytes written, %u files opened\n",
+           (unsigned long long)card.stats().bytesWritten, card.stats().opens);
+    card.resetStats();
+
+    // Then a day of wakes, each a fresh DataManager as after deep sleep
+    StatusRecord status = {false, "Harness", "T4", 72, false, now};
+    for (int w = 0; w < WAKES; w++)
+    {
+        time_t last = now;
+        now += WAKE_SECONDS;
+        Clock::setFake(now);
+
+        DataManager dataManager;
+        dataManager.begin(card);
+        {
+            Stopwatch t{"getStatus"};
+            dataManager.getStatus();
+        }
+        time_t latest;
+        {
+            Stopwatch t{"getLatestTimestamp"};
+            latest = dataManager.getLatestTimestamp();
+        }
+
+        PetDataMap petData;
+        {
+            Stopwatch t{"loadData"};
+            dataManager.loadData(petData, latest - 86400);
+        }
+        size_t added = 0;
+        for (int p = 0; p < PET_COUNT; p++)
+        {
+            std::vector<LitterboxRecord> records = visits(1000 + p, last, now);
+            Stopwatch t{"mergeData"};
+            added += dataManager.mergeData(petData, 1000 + p, records);
+        }
+        if (added > 0)
+        {
+            Stopwatch t{"saveData"};
+            dataManager.saveData();
+        }
+
+        status.timestamp = now;
+        status.litter_percent = 72 - w;
+        Stopwatch t{"saveStatus"};
+        dataManager.saveStatus(status);
+    }
+    printf("%d wakes: %llu bytes written, %llu read, %u files opened\n\n", WAKES,
+           (unsigned long long)card.stats().bytesWritten, (unsigned long long)card.stats().bytesRead, card.stats().opens);
+
+    printf("%-20s %8s %12s %12s\n", "call", "calls", "total ms", "mean ms");
+    for (const auto &t : timings)
+        printf("%-20s %8u %12.3f %12.3f\n", t.first.c_str(), t.second.calls, t.second.ms, t.second.ms / t.second.calls);
+
+    uintmax_t total = 0;
+    size_t files = 0;
+    for (const auto &entry : std::filesystem::recursive_directory_iterator(root))
+    {
+        if (!entry.is_regular_file())
+            continue;
+        total += entry.file_size();
+        files++;
+    }
+    printf("\nOn the card: %zu files, %ju bytes\n", files, total);
+    return 0;
+}
@@ -0,0 +1,11 @@
+#include "Clock.h"
+
+time_t Clock::_fake = 0;
+
+time_t Clock::now() {
+    return _fake != 0 ? _fake : time(NULL);
+}
+
+void Clock::setFake(time_t now) {
+    _fake = now;
+}
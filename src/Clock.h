@@ -0,0 +1,23 @@
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <time.h>
+
+/**
+ * @brief Wall clock for everything that stamps, windows or prunes history.
+ *
+ * Reads the system time, which the RTC and NTP keep set on the device. Host
+ * builds can pin it with setFake so runs over the same data are repeatable.
+ */
+class Clock {
+public:
+    static time_t now();
+
+    // Report `now` until cleared with 0
+    static void setFake(time_t now);
+
+private:
+    static time_t _fake;
+};
+
+#endif
@@ -0,0 +1,14 @@
+#include "Crc32.h"
+
+uint32_t crc32(const void *data, size_t length, uint32_t crc) {
+    // Bitwise rather than table driven: the inputs are a few KB at most
+    const uint8_t *p = static_cast<const uint8_t *>(data);
+    crc = ~crc;
+    while (length--) {
+        crc ^= *p++;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
@@ -1,151 +1,1180 @@
 #include "DataManager.h"
+#include "Crc32.h"
+#include <algorithm>
+#include <functional>
 
 DataManager::DataManager() {}
 
-bool DataManager::begin(SPIClass &spi) {
-    pinMode(SD_EN_PIN, OUTPUT);
-    digitalWrite(SD_EN_PIN, HIGH);
-    pinMode(SD_DET_PIN, INPUT_PULLUP);
-    delay(100);
-
-    if (digitalRead(SD_DET_PIN)) {
-        Serial.println("[DataManager] No SD card detected.");
-        return false;
-    }
-
-    // We use the shared SPI instance passed from main
-    if (!SD.begin(SD_CS_PIN, spi)) {
-        Serial.println("[DataManager] SD Mount Failed!");
-        return false;
-    }
-    
-    Serial.println("[DataManager] SD Card Mounted.");
-    return true;
+void DataManager::begin(fs::FS &fs) {
+    _hot.begin();
+    _fs = &fs;
 }
 
-void DataManager::loadData(PetDataMap &petData) {
-    const char* tempFilename = "/pet_data.tmp";
+void DataManager::loadData(PetDataMap &petData, time_t since, const std::vector<int> &petIds) {
+    // Short ranges are often entirely in the RTC cache
+    if (_hot.covers(since)) {
+        size_t filled = _hot.fill(petData, since, petIds);
+        if (petIds.empty()) _loadedSince = since;
+        Serial.printf("[DataManager] Historical data loaded: %u records from RTC cache.\r\n", (unsigned)filled);
+        return;
+    }
 
     // crash recovery
-    // Scenario: Power failed after deleting .json but before renaming .tmp
-    if (!SD.exists(_filename) && SD.exists(tempFilename)) {
-        Serial.println("[DataManager] Detected failed save. Recovering from temp file...");
-        if (SD.rename(tempFilename, _filename)) {
+    // Scenario: Power failed after deleting the manifest but before renaming .tmp
+    if (!_fs->exists(_manifestFilename) && _fs->exists(_manifestTempFilename)) {
+        Serial.println("[DataManager] Detected failed manifest save. Recovering from temp file...");
+        if (_fs->rename(_manifestTempFilename, _manifestFilename)) {
             Serial.println("[DataManager] Recovery successful!");
         } else {
-            Serial.println("[DataManager] Recovery rename failed. Attempting to load temp file directly.");
-            // If rename fails, we can try to read the temp file directly below
-            // by temporarily swapping the pointer, but usually rename works.
+            Serial.println("[DataManager] Recovery rename failed.");
         }
     }
 
-    // Check again (in case we just recovered it)
-    if (!SD.exists(_filename)) {
-        Serial.println("[DataManager] No data file found. Creating new.");
+    // One-time migration from the older single-file histories
+    if (!_fs->exists(_manifestFilename) && (_fs->exists(_legacyLogFilename) || _fs->exists(_legacyFilename))) {
+        migrateLegacy(petData);
+        _loadedSince = 0;
         return;
     }
 
-    File file = SD.open(_filename, FILE_READ);
-    if (!file) return;
+    if (!loadManifest()) {
+        if (!_fs->exists(_historyDir)) {
+            Serial.println("[DataManager] No data file found. Creating new.");
+            _loadedSince = 0;
+            return;
+        }
+        // Shards are self-describing, so a lost manifest can be rebuilt from the directory
+        rebuildManifest();
+    }
 
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, file);
+    time_t pruneTimestamp = Clock::now() - DATA_RETENTION_SECONDS;
+    if (since < pruneTimestamp) since = pruneTimestamp;
+
+    uint32_t loaded = 0, shards = 0;
+    std::vector<HistorySample> samples;
+    for (const ManifestEntry &entry : _manifest) {
+        if (!petIds.empty() && std::find(petIds.begin(), petIds.end(), entry.petId) == petIds.end()) continue;
+        if (monthEnd(entry.month) <= since) continue;
+
+        samples.clear();
+        if (!readShard(shardPath(entry.petId, entry.month), samples)) continue;
+        shards++;
+
+        // Shards hold at most a month, so decoding one whole costs less than seeking within it.
+        // The manifest is in pet/month order, so these are plain appends.
+        PetSeries &series = petData[entry.petId];
+        series.reserve(series.size() + samples.size());
+        for (const HistorySample &sample : samples) {
+            if ((time_t)sample.timestamp < since) continue;
+            series.insert(sample.timestamp, sample.weightGrams, sample.durationSeconds);
+            loaded++;
+        }
+    }
+
+    // Journal records are newer than anything in the shards, so they go in last
+    loadJournal();
+    for (const LitterboxRecord &rec : _journal) {
+        if (!petIds.empty() && std::find(petIds.begin(), petIds.end(), rec.pet_id) == petIds.end()) continue;
+        if (rec.timestamp < since) continue;
+        petData[rec.pet_id].insert(rec.timestamp, rec.weight_grams, rec.duration_seconds);
+        loaded++;
+    }
+    Serial.printf("[DataManager] Historical data loaded: %u records from %u of %u shards and the journal.\r\n", loaded, shards, (unsigned)_manifest.size());
+
+    // Every pet was loaded from since onwards, so the newest of it can serve later wakes
+    if (petIds.empty()) {
+        _loadedSince = since;
+        _hot.seed(petData, since);
+    }
+}
+
+uint32_t DataManager::readLog(File &file, const std::function<void(const LogRecord &)> &onRecord) {
+    LogHeader header;
+    if (!readHeader(file, header)) {
+        Serial.printf("[DataManager] Log header invalid, ignoring %s.\r\n", file.name());
+        // leave corrupted file, might be manually recoverable.
+        return 0;
+    }
+
+    // Trust the file size over the header: an append that lost power before
+    // the header rewrite still left complete records behind.
+    uint32_t remaining = (file.size() - sizeof(LogHeader)) / sizeof(LogRecord);
+    LogRecord chunk[32];
+    uint32_t count = 0;
+    while (remaining > 0) {
+        uint32_t n = std::min<uint32_t>(remaining, sizeof(chunk) / sizeof(chunk[0]));
+        if (file.read((uint8_t *)chunk, n * sizeof(LogRecord)) != n * sizeof(LogRecord)) break;
+        for (uint32_t i = 0; i < n; i++) {
+            onRecord(chunk[i]);
+        }
+        count += n;
+        remaining -= n;
+    }
+    return count;
+}
+
+bool DataManager::readShard(const String &path, std::vector<HistorySample> &samples) {
+    if (_fs->exists(path)) return decodeShard(path, samples);
+
+    // Same recovery as the manifest and journal: power failed between remove
+    // and rename. writeShard() only removes the shard once the temp file is
+    // complete, but it is checked the same way before it takes the shard's place.
+    String tempPath = path + ".tmp";
+    if (!_fs->exists(tempPath) || !decodeShard(tempPath, samples)) return false;
+    Serial.printf("[DataManager] Detected failed save of %s. Recovering from temp file...\r\n", path.c_str());
+    if (!_fs->rename(tempPath, path)) {
+        Serial.println("[DataManager] Recovery rename failed.");
+    }
+    return true;
+}
+
+bool DataManager::decodeShard(const String &path, std::vector<HistorySample> &samples) {
+    File file = _fs->open(path, FILE_READ);
+    if (!file) return false;
+
+    ShardHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) >= offsetof(ShardHeader, reserved) && header.magic == LOG_MAGIC;
+    if (ok && header.version == LOG_VERSION) {
+        // Fixed-width shard from before the columnar encoding; rewritten as one on the next save
+        file.seek(0);
+        readLog(file, [&](const LogRecord &rec) {
+            samples.push_back({rec.timestamp, rec.weightGrams, rec.durationSeconds});
+        });
+        file.close();
+        return true;
+    }
+
+    ok = ok && header.version == SHARD_VERSION && header.blockBytes == file.size() - sizeof(ShardHeader);
+    if (ok) {
+        std::vector<uint8_t> block(header.blockBytes);
+        ok = file.read(block.data(), block.size()) == block.size() &&
+             HistoryCodec::decodeBlock(block.data(), block.size(), samples) == block.size() &&
+             samples.size() == header.recordCount;
+    }
     file.close();
 
-    if (error) {
-        Serial.print("[DataManager] JSON Parse Error: ");
-        Serial.println(error.c_str());
+    if (!ok) {
+        Serial.printf("[DataManager] Shard %s is invalid, ignoring it.\r\n", path.c_str());
         // leave corrupted file, might be manually recoverable.
+        samples.clear();
+    }
+    return ok;
+}
+
+void DataManager::migrateLegacy(PetDataMap &petData) {
+    Serial.println("[DataManager] Migrating legacy history to sharded storage...");
+    auto queue = [&](const LitterboxRecord &rec) {
+        petData[rec.pet_id].insert(rec.timestamp, rec.weight_grams, rec.duration_seconds);
+        _pending.push_back(rec);
+    };
+
+    const char *source = nullptr;
+    if (_fs->exists(_legacyLogFilename)) {
+        File file = _fs->open(_legacyLogFilename, FILE_READ);
+        if (!file) return;
+        readLog(file, [&](const LogRecord &rec) {
+            LitterboxRecord record;
+            record.timestamp = rec.timestamp;
+            record.weight_grams = rec.weightGrams;
+            record.duration_seconds = rec.durationSeconds;
+            record.pet_id = rec.petId;
+            queue(record);
+        });
+        file.close();
+        source = _legacyLogFilename;
+    } else {
+        File file = _fs->open(_legacyFilename, FILE_READ);
+        if (!file) return;
+
+        JsonDocument doc;
+        DeserializationError error = deserializeJson(doc, file);
+        file.close();
+
+        if (error) {
+            Serial.print("[DataManager] JSON Parse Error: ");
+            Serial.println(error.c_str());
+            // leave corrupted file, might be manually recoverable.
+            return;
+        }
+
+        JsonObject root = doc.as<JsonObject>();
+        for (JsonPair petPair : root) {
+            int petId = atoi(petPair.key().c_str());
+            JsonArray records = petPair.value().as<JsonArray>();
+
+            for (JsonObject recordJson : records) {
+                LitterboxRecord rec;
+                rec.timestamp = recordJson["ts"];
+                rec.weight_grams = recordJson["w_g"];
+                rec.duration_seconds = recordJson["dur_s"];
+                rec.pet_id = petId;
+                queue(rec);
+            }
+        }
+        source = _legacyFilename;
+    }
+
+    // Straight into the shards rather than waiting for the journal to fill
+    saveData();
+    bool compacted = _pending.empty() && compactJournal();
+
+    // Keep the old file around rather than deleting it, in case the shards are bad
+    if (compacted && _fs->exists(_manifestFilename)) {
+        String backup = String(source) + ".bak";
+        _fs->remove(backup);
+        _fs->rename(source, backup);
+        Serial.println("[DataManager] Migration complete.");
+    }
+}
+
+bool DataManager::readHeader(File &file, LogHeader &header) {
+    if (file.read((uint8_t *)&header, sizeof(header)) != sizeof(header)) return false;
+    return header.magic == LOG_MAGIC && header.version == LOG_VERSION && header.recordSize == sizeof(LogRecord);
+}
+
+void DataManager::saveData() {
+    if (_pending.empty()) {
+        Serial.println("[DataManager] No new records to save.");
         return;
     }
 
-    JsonObject root = doc.as<JsonObject>();
-    for (JsonPair petPair : root) {
-        int petId = atoi(petPair.key().c_str());
-        JsonArray records = petPair.value().as<JsonArray>();
+    if (!_fs->exists(_historyDir)) {
+        _fs->mkdir(_historyDir);
+    }
+    loadJournal();
+
+    // Durable once the frame is on the card; the shards catch up at the next compaction
+    if (!appendJournal(_pending)) {
+        Serial.println("[DataManager] Journal append failed, will retry on the next save.");
+        return;
+    }
 
-        for (JsonObject recordJson : records) {
-            LitterboxRecord rec;
-            rec.timestamp = recordJson["ts"];
-            rec.weight_grams = recordJson["w_g"];
-            rec.duration_seconds = recordJson["dur_s"];
-            rec.pet_id = petId;
-            petData[petId][rec.timestamp] = rec;
+    _hot.addRecords(_pending.data(), _pending.size());
+    time_t latest = 0, known;
+    for (const LitterboxRecord &rec : _pending) {
+        latest = std::max(latest, rec.timestamp);
+    }
+    if (_hot.getLatestTimestamp(known) && latest > known) {
+        _hot.setLatestTimestamp(latest);
+    }
+    _pending.clear();
+
+    saveRollups(Clock::now() - DATA_RETENTION_SECONDS);
+
+    if (_journalBytes >= JOURNAL_COMPACT_BYTES) {
+        compactJournal();
+    }
+}
+
+bool DataManager::compactJournal() {
+    loadJournal();
+    if (_journal.empty()) return true;
+
+    if (!_manifestLoaded && !loadManifest() && _fs->exists(_historyDir)) {
+        rebuildManifest();
+    }
+    if (!_fs->exists(_historyDir)) {
+        _fs->mkdir(_historyDir);
+    }
+
+    // Group by shard: pet first, then time, so each pet-month is one contiguous run.
+    // Stable, so of two frames holding the same visit the later one wins below.
+    std::vector<LitterboxRecord> records(_journal);
+    std::stable_sort(records.begin(), records.end(), [](const LitterboxRecord &a, const LitterboxRecord &b) {
+        if (a.pet_id != b.pet_id) return a.pet_id < b.pet_id;
+        return a.timestamp < b.timestamp;
+    });
+    size_t kept = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (kept > 0 && records[kept - 1].pet_id == records[i].pet_id && records[kept - 1].timestamp == records[i].timestamp) {
+            records[kept - 1] = records[i];
+        } else {
+            records[kept++] = records[i];
         }
     }
-    Serial.println("[DataManager] Historical data loaded.");
+    records.resize(kept);
+
+    time_t pruneTimestamp = Clock::now() - DATA_RETENTION_SECONDS;
+    bool ok = true;
+    size_t start = 0;
+    while (start < records.size()) {
+        int petId = records[start].pet_id;
+        uint32_t month = monthOf(records[start].timestamp);
+        size_t end = start + 1;
+        while (end < records.size() && records[end].pet_id == petId && monthOf(records[end].timestamp) == month) {
+            end++;
+        }
+
+        if (monthEnd(month) > pruneTimestamp) {
+            ManifestEntry *entry = findShard(petId, month);
+            if (!entry) {
+                _manifest.push_back({petId, month, 0});
+                entry = &_manifest.back();
+            }
+            ok = writeShard(*entry, &records[start], end - start) && ok;
+        }
+        start = end;
+    }
+
+    // Replaying the journal is idempotent, so on any failure it is simply kept for next time
+    if (!ok) {
+        Serial.println("[DataManager] Compaction incomplete, journal kept.");
+        return false;
+    }
+    pruneShards(pruneTimestamp);
+    _dataVersion = _journalSeq;
+    if (!saveManifest()) return false;
+
+    _fs->remove(_journalFilename);
+    Serial.printf("[DataManager] Compacted %u journal records into the shards.\r\n", (unsigned)_journal.size());
+    _journal.clear();
+    _journalBytes = 0;
+    return true;
 }
 
-void DataManager::saveData(const PetDataMap &petData) {
-    // ATOMIC SAVE
-    const char* tempFilename = "/pet_data.tmp";
-    
-    //Delete temp file if it exists (cleanup from previous crash)
-    if (SD.exists(tempFilename)) {
-        SD.remove(tempFilename);
+void DataManager::loadJournal() {
+    if (_journalLoaded) return;
+    _journalLoaded = true;
+    if (!_manifestLoaded) loadManifest();
+    _journalSeq = _dataVersion;
+    _journal.clear();
+    _journalBytes = 0;
+
+    // Same recovery as the manifest: power failed between remove and rename
+    if (!_fs->exists(_journalFilename) && _fs->exists(_journalTempFilename)) {
+        _fs->rename(_journalTempFilename, _journalFilename);
     }
 
-    //Write all present data to a .tmp file
-    File file = SD.open(tempFilename, FILE_WRITE);
+    File file = _fs->open(_journalFilename, FILE_READ);
+    if (!file) return;
+
+    size_t size = file.size();
+    size_t offset = 0;
+    uint32_t frames = 0;
+    std::vector<LogRecord> records;
+    while (offset + sizeof(JournalFrame) <= size) {
+        JournalFrame frame;
+        if (file.read((uint8_t *)&frame, sizeof(frame)) != sizeof(frame) || frame.magic != JOURNAL_MAGIC) break;
+        if (frame.recordCount > (size - offset - sizeof(frame)) / sizeof(LogRecord)) break;
+
+        records.resize(frame.recordCount);
+        size_t bytes = frame.recordCount * sizeof(LogRecord);
+        if (file.read((uint8_t *)records.data(), bytes) != bytes) break;
+        uint32_t crc = crc32(&frame, offsetof(JournalFrame, crc));
+        if (crc32(records.data(), bytes, crc) != frame.crc) break;
+
+        for (const LogRecord &rec : records) {
+            LitterboxRecord record;
+            record.timestamp = rec.timestamp;
+            record.weight_grams = rec.weightGrams;
+            record.duration_seconds = rec.durationSeconds;
+            record.pet_id = rec.petId;
+            _journal.push_back(record);
+        }
+        _journalSeq = std::max(_journalSeq, frame.sequence);
+        offset += sizeof(frame) + bytes;
+        frames++;
+    }
+    file.close();
+    _journalBytes = offset;
+
+    if (offset < size) {
+        Serial.printf("[DataManager] Journal damaged after %u frames, truncating %u bytes.\r\n", frames, (unsigned)(size - offset));
+        truncateJournal(offset);
+    }
+}
+
+bool DataManager::appendJournal(const std::vector<LitterboxRecord> &records) {
+    std::vector<LogRecord> log;
+    log.reserve(records.size());
+    for (const LitterboxRecord &rec : records) {
+        log.push_back({(uint32_t)rec.timestamp, rec.pet_id, rec.weight_grams, rec.duration_seconds});
+    }
+
+    JournalFrame frame = {JOURNAL_MAGIC, _journalSeq + 1, (uint32_t)log.size(), 0};
+    size_t bytes = log.size() * sizeof(LogRecord);
+    frame.crc = crc32(log.data(), bytes, crc32(&frame, offsetof(JournalFrame, crc)));
+
+    File file = _fs->open(_journalFilename, FILE_APPEND);
     if (!file) {
-        Serial.println("[DataManager] Failed to open temp file for writing!");
+        Serial.println("[DataManager] Failed to open journal!");
+        return false;
+    }
+    bool ok = file.write((const uint8_t *)&frame, sizeof(frame)) == sizeof(frame) &&
+              file.write((const uint8_t *)log.data(), bytes) == bytes;
+    //Ensure data is physically on the card before close
+    file.flush();
+    file.close();
+
+    if (!ok) {
+        // Whatever part of the frame landed is cut off by the next scan
+        _journalLoaded = false;
+        return false;
+    }
+    _journalSeq = frame.sequence;
+    _journalBytes += sizeof(frame) + bytes;
+    _journal.insert(_journal.end(), records.begin(), records.end());
+    return true;
+}
+
+// Keep the first `length` bytes. The FS API cannot truncate in place, so the
+// good prefix is copied out and swapped in like any other atomic save.
+void DataManager::truncateJournal(size_t length) {
+    if (length == 0) {
+        _fs->remove(_journalFilename);
         return;
     }
 
-    JsonDocument doc; 
-    JsonObject root = doc.to<JsonObject>();
+    if (_fs->exists(_journalTempFilename)) {
+        _fs->remove(_journalTempFilename);
+    }
+    File in = _fs->open(_journalFilename, FILE_READ);
+    File out = _fs->open(_journalTempFilename, FILE_WRITE);
+    if (!in || !out) {
+        Serial.println("[DataManager] Journal truncation failed!");
+        return;
+    }
+    uint8_t buf[512];
+    size_t copied = 0;
+    while (copied < length) {
+        size_t n = in.read(buf, std::min(sizeof(buf), length - copied));
+        if (n == 0 || out.write(buf, n) != n) break;
+        copied += n;
+    }
+    out.flush();
+    out.close();
+    in.close();
+    if (copied != length) {
+        Serial.println("[DataManager] Journal truncation failed!");
+        _fs->remove(_journalTempFilename);
+        return;
+    }
 
-    time_t now = time(NULL);
-    time_t pruneTimestamp = now - (365 * 86400L); // Keep 365 days
-    
-    for (auto const &petPair : petData) {
-        int petId = petPair.first;
-        JsonArray petArray = root[String(petId)].to<JsonArray>();
+    //If crash here (after remove, before rename), loadJournal() recovers the temp file.
+    _fs->remove(_journalFilename);
+    _fs->rename(_journalTempFilename, _journalFilename);
+}
 
-        for (auto const &recordPair : petPair.second) {
-            const LitterboxRecord &record = recordPair.second;
-            if (record.timestamp < pruneTimestamp) continue;
+bool DataManager::writeShard(ManifestEntry &entry, const LitterboxRecord *records, size_t count) {
+    String path = shardPath(entry.petId, entry.month);
 
-            JsonObject recJson = petArray.add<JsonObject>();
-            recJson["ts"] = record.timestamp;
-            recJson["w_g"] = record.weight_grams;
-            recJson["dur_s"] = record.duration_seconds;
+    // A month of one pet encodes to well under a kilobyte, so the shard is
+    // simply re-encoded with the new records merged in
+    std::vector<HistorySample> existing;
+    readShard(path, existing);
+
+    // Both sides are sorted; on equal timestamps the new record replaces the old one
+    std::vector<HistorySample> merged;
+    merged.reserve(existing.size() + count);
+    size_t next = 0;
+    for (const HistorySample &sample : existing) {
+        while (next < count && (uint32_t)records[next].timestamp < sample.timestamp) {
+            merged.push_back(toSample(records[next++]));
         }
+        if (next < count && (uint32_t)records[next].timestamp == sample.timestamp) continue;
+        merged.push_back(sample);
+    }
+    while (next < count) {
+        merged.push_back(toSample(records[next++]));
     }
 
-    if (serializeJson(doc, file) == 0) {
-        Serial.println("[DataManager] Failed to write JSON content!");
-        file.close();
-        return;
+    std::vector<uint8_t> block;
+    HistoryCodec::encodeBlock(merged.data(), merged.size(), block);
+
+    ShardHeader header = {LOG_MAGIC, SHARD_VERSION, 0, (uint32_t)merged.size(),
+                          merged.front().timestamp, merged.back().timestamp, (uint32_t)block.size()};
+
+    // ATOMIC SAVE
+    String tempPath = path + ".tmp";
+    //Delete temp file if it exists (cleanup from previous crash; readShard()
+    //above has already promoted one that stood in for a missing shard)
+    if (_fs->exists(tempPath)) {
+        _fs->remove(tempPath);
     }
-    
+
+    File out = _fs->open(tempPath, FILE_WRITE);
+    if (!out) {
+        Serial.println("[DataManager] Failed to open temp file for writing!");
+        return false;
+    }
+    bool ok = out.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              out.write(block.data(), block.size()) == block.size();
+
     //Ensure data is physically on the card before close
-    file.flush(); 
-    file.close();
-    
+    out.flush();
+    out.close();
+
     //Verify the Temp File
-    File checkFile = SD.open(tempFilename);
-    if (!checkFile || checkFile.size() == 0) {
+    File checkFile = _fs->open(tempPath);
+    if (!ok || !checkFile || checkFile.size() != sizeof(header) + block.size()) {
          Serial.println("[DataManager] Temp file is invalid. Aborting save.");
          if(checkFile) checkFile.close();
-         return;
+         return false;
     }
     checkFile.close();
 
+    //If crash here (after remove, before rename), readShard() recovers the temp file.
+    if (_fs->exists(path)) {
+        _fs->remove(path);
+    }
+
+    if (_fs->rename(tempPath, path)) {
+        entry.recordCount = merged.size();
+        Serial.printf("[DataManager] Wrote %s: %u records in %u bytes.\r\n", path.c_str(), (unsigned)merged.size(), (unsigned)block.size());
+        return true;
+    }
+    Serial.println("[DataManager] Rename failed!");
+    return false;
+}
+
+void DataManager::pruneShards(time_t pruneTimestamp) {
+    // Retention works a whole month at a time: a shard goes once its newest
+    // possible record is past the cutoff. loadData() trims the partial month.
+    for (size_t i = 0; i < _manifest.size();) {
+        if (monthEnd(_manifest[i].month) <= pruneTimestamp) {
+            String path = shardPath(_manifest[i].petId, _manifest[i].month);
+            _fs->remove(path);
+            Serial.printf("[DataManager] Pruned %s.\r\n", path.c_str());
+            _manifest.erase(_manifest.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+bool DataManager::loadManifest() {
+    _manifest.clear();
+    File file = _fs->open(_manifestFilename, FILE_READ);
+    if (!file) return false;
+
+    ManifestHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == MANIFEST_MAGIC && header.version == MANIFEST_VERSION &&
+              header.entrySize == sizeof(ManifestEntry);
+    if (ok) {
+        _manifest.resize(header.entryCount);
+        size_t bytes = header.entryCount * sizeof(ManifestEntry);
+        ok = file.read((uint8_t *)_manifest.data(), bytes) == bytes;
+    }
+    file.close();
+
+    if (!ok) {
+        Serial.println("[DataManager] Manifest invalid.");
+        _manifest.clear();
+        return false;
+    }
+    _dataVersion = header.dataVersion;
+    sortManifest();
+    _manifestLoaded = true;
+    return true;
+}
+
+// Pet/month order, so loads append each pet's shards oldest first
+void DataManager::sortManifest() {
+    std::sort(_manifest.begin(), _manifest.end(), [](const ManifestEntry &a, const ManifestEntry &b) {
+        return a.petId != b.petId ? a.petId < b.petId : a.month < b.month;
+    });
+}
+
+bool DataManager::saveManifest() {
+    if (_fs->exists(_manifestTempFilename)) {
+        _fs->remove(_manifestTempFilename);
+    }
+
+    sortManifest();
+    File file = _fs->open(_manifestTempFilename, FILE_WRITE);
+    if (!file) {
+        Serial.println("[DataManager] Failed to open manifest for writing!");
+        return false;
+    }
+    ManifestHeader header = {MANIFEST_MAGIC, MANIFEST_VERSION, sizeof(ManifestEntry), (uint32_t)_manifest.size(), _dataVersion};
+    size_t bytes = _manifest.size() * sizeof(ManifestEntry);
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)_manifest.data(), bytes) == bytes;
+    file.flush();
+    file.close();
+    if (!ok) {
+        Serial.println("[DataManager] Manifest write failed!");
+        return false;
+    }
+
     //If crash here (after remove, before rename), the 'Recovery Logic' in loadData() handles it.
-    if (SD.exists(_filename)) {
-        SD.remove(_filename);
+    if (_fs->exists(_manifestFilename)) {
+        _fs->remove(_manifestFilename);
     }
-    
-    if (SD.rename(tempFilename, _filename)) {
-        Serial.println("[DataManager] Atomic Save Complete.");
+    if (!_fs->rename(_manifestTempFilename, _manifestFilename)) {
+        Serial.println("[DataManager] Manifest rename failed!");
+        return false;
+    }
+    _manifestLoaded = true;
+    return true;
+}
+
+void DataManager::rebuildManifest() {
+    Serial.println("[DataManager] Rebuilding manifest from shard files...");
+    _manifest.clear();
+    // The old stamp is lost; start from one no earlier cache can be keyed on
+    _dataVersion = (uint32_t)Clock::now();
+    _journalSeq = std::max(_journalSeq, _dataVersion);
+    File dir = _fs->open(_historyDir);
+    if (!dir) return;
+
+    std::vector<HistorySample> samples;
+    File file;
+    while ((file = dir.openNextFile())) {
+        const char *name = strrchr(file.name(), '/');
+        name = name ? name + 1 : file.name();
+        int petId;
+        unsigned month;
+        char ext[9];
+        bool isShard = sscanf(name, "%d_%u.%8s", &petId, &month, ext) == 3 &&
+                       (strcmp(ext, "bin") == 0 ||
+                        // A temp file standing in for a missing shard; readShard() promotes it
+                        (strcmp(ext, "bin.tmp") == 0 && !_fs->exists(shardPath(petId, month))));
+        file.close();
+        samples.clear();
+        // A promoted temp file may come up again under its new name
+        if (isShard && !findShard(petId, month) && readShard(shardPath(petId, month), samples)) {
+            _manifest.push_back({petId, month, (uint32_t)samples.size()});
+        }
+    }
+    dir.close();
+    saveManifest();
+}
+
+uint32_t DataManager::getDataVersion() {
+    // Every saved batch gets the next journal sequence, compacted or not
+    loadJournal();
+    return _journalSeq;
+}
+
+DataManager::ManifestEntry *DataManager::findShard(int petId, uint32_t month) {
+    for (auto &entry : _manifest) {
+        if (entry.petId == petId && entry.month == month) return &entry;
+    }
+    return nullptr;
+}
+
+String DataManager::shardPath(int petId, uint32_t month) {
+    char path[40];
+    snprintf(path, sizeof(path), "%s/%d_%u.bin", _historyDir, petId, (unsigned)month);
+    return String(path);
+}
+
+void DataManager::loadRollups(PetRollupMap &rollups, time_t since, const std::vector<int> &petIds) {
+    std::vector<int> pets(petIds);
+    if (pets.empty()) {
+        if (!_manifestLoaded) loadManifest();
+        for (const ManifestEntry &entry : _manifest) {
+            if (std::find(pets.begin(), pets.end(), entry.petId) == pets.end()) pets.push_back(entry.petId);
+        }
+        // Pets whose records are all still in the journal have no shard yet
+        loadJournal();
+        for (const LitterboxRecord &rec : _journal) {
+            if (std::find(pets.begin(), pets.end(), rec.pet_id) == pets.end()) pets.push_back(rec.pet_id);
+        }
+    }
+
+    time_t pruneTimestamp = Clock::now() - DATA_RETENTION_SECONDS;
+    if (since < pruneTimestamp) since = pruneTimestamp;
+    uint32_t sinceDay = since > 0 ? since / 86400 : 0;
+
+    for (int petId : pets) {
+        RollupState &state = rollupFor(petId);
+        PetRollups &out = rollups[petId];
+        if (!sumBuckets(state, sinceDay, out.buckets)) {
+            Serial.printf("[DataManager] Buckets for pet %d are invalid.\r\n", petId);
+            rebuildRollup(state);
+            if (!sumBuckets(state, sinceDay, out.buckets)) out.buckets = {};
+        }
+        out.days.clear();
+        for (const DailyRollup &day : state.days) {
+            if (day.visits > 0 && day.day >= sinceDay) out.days.push_back(day);
+        }
+    }
+}
+
+DataManager::RollupState &DataManager::rollupFor(int petId) {
+    for (auto &state : _rollups) {
+        if (state.petId == petId) return state;
+    }
+
+    _rollups.push_back({petId, 0, {}, 0, UINT32_MAX, {}, false});
+    RollupState &state = _rollups.back();
+    if (!readRollup(state)) {
+        rebuildRollup(state);
+    }
+    return state;
+}
+
+bool DataManager::readRollup(RollupState &state) {
+    File file = _fs->open(rollupPath(state.petId), FILE_READ);
+    if (!file) return false;
+
+    RollupHeader header;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == ROLLUP_MAGIC && header.version == ROLLUP_VERSION &&
+              header.entrySize == sizeof(DailyRollup) && header.petId == state.petId;
+    if (ok) {
+        state.days.resize(header.dayCount);
+        size_t bytes = header.dayCount * sizeof(DailyRollup);
+        ok = file.read((uint8_t *)state.days.data(), bytes) == bytes;
+    }
+    file.close();
+
+    if (!ok) {
+        Serial.printf("[DataManager] Rollup for pet %d is invalid.\r\n", state.petId);
+        state.days.clear();
+        return false;
+    }
+    state.firstDay = header.firstDay;
+    state.savedDays = header.dayCount;
+    state.dirtyFrom = UINT32_MAX;
+    return true;
+}
+
+void DataManager::rebuildRollup(RollupState &state) {
+    if (!_manifestLoaded) loadManifest();
+
+    // One-time cost per pet: read every shard and aggregate it day by day
+    PetSeries series(state.petId);
+    std::vector<HistorySample> samples;
+    for (const ManifestEntry &entry : _manifest) {
+        if (entry.petId != state.petId) continue;
+        samples.clear();
+        if (!readShard(shardPath(entry.petId, entry.month), samples)) continue;
+        for (const HistorySample &sample : samples) {
+            series.insert(sample.timestamp, sample.weightGrams, sample.durationSeconds);
+        }
+    }
+    loadJournal();
+    for (const LitterboxRecord &rec : _journal) {
+        if (rec.pet_id == state.petId) series.insert(rec.timestamp, rec.weight_grams, rec.duration_seconds);
+    }
+
+    state.days.clear();
+    state.savedDays = 0;
+    state.dirtyFrom = UINT32_MAX;
+    state.counts.clear();
+    state.countsRebuilt = true;
+    size_t lo = 0;
+    while (lo < series.size()) {
+        uint32_t day = series.timestamp(lo) / 86400;
+        size_t hi = lo;
+        while (hi < series.size() && (uint32_t)(series.timestamp(hi) / 86400) == day) hi++;
+        BucketCounts counts;
+        DailyRollup rollup = aggregateDay(series, day, lo, hi, counts);
+        setRollupDay(state, rollup, counts);
+        lo = hi;
+    }
+    Serial.printf("[DataManager] Rebuilt %u days of rollups for pet %d.\r\n", (unsigned)state.days.size(), state.petId);
+}
+
+void DataManager::updateRollup(const PetSeries &series, const std::vector<LitterboxRecord> &changed) {
+    // A new visit changes its own day, and the interval of the visit after it
+    std::vector<uint32_t> days;
+    for (const LitterboxRecord &record : changed) {
+        days.push_back(record.timestamp / 86400);
+        size_t next = series.lowerBound(record.timestamp) + 1;
+        if (next < series.size()) days.push_back(series.timestamp(next) / 86400);
+    }
+    std::sort(days.begin(), days.end());
+    days.erase(std::unique(days.begin(), days.end()), days.end());
+
+    // The series holds what loadData() read, from _loadedSince on, and what
+    // was merged into it. A day it does not hold whole, or whose first visit's
+    // previous one it may not hold, is aggregated from the card instead, with
+    // the series laid over it.
+    std::vector<bool> held(days.size());
+    uint32_t firstMissing = UINT32_MAX, lastMissing = 0;
+    for (size_t k = 0; k < days.size(); k++) {
+        time_t start = (time_t)days[k] * 86400L;
+        size_t lo = series.lowerBound(start);
+        held[k] = _loadedSince >= 0 && start >= _loadedSince && lo > 0 && series.timestamp(lo - 1) >= _loadedSince;
+        if (!held[k]) {
+            firstMissing = std::min(firstMissing, days[k]);
+            lastMissing = std::max(lastMissing, days[k]);
+        }
+    }
+    PetSeries full(series.petId());
+    if (firstMissing != UINT32_MAX) {
+        readDays(full, firstMissing, lastMissing);
+        for (size_t i = 0; i < series.size(); i++) {
+            full.insert(series.timestamp(i), series.weight(i), series.duration(i));
+        }
+    }
+
+    RollupState &state = rollupFor(series.petId());
+    for (size_t k = 0; k < days.size(); k++) {
+        const PetSeries &from = held[k] ? series : full;
+        size_t lo = from.lowerBound((time_t)days[k] * 86400L);
+        size_t hi = from.lowerBound((time_t)(days[k] + 1) * 86400L);
+        BucketCounts counts;
+        DailyRollup rollup = aggregateDay(from, days[k], lo, hi, counts);
+        setRollupDay(state, rollup, counts);
+    }
+}
+
+void DataManager::readDays(PetSeries &out, uint32_t first, uint32_t last) {
+    if (!_manifestLoaded) loadManifest();
+    time_t from = (time_t)first * 86400L;
+    time_t to = (time_t)(last + 1) * 86400L;
+
+    // The journal is newer than the shards, so it goes in last
+    loadJournal();
+    bool before = false;
+    for (const LitterboxRecord &rec : _journal) {
+        if (rec.pet_id == out.petId() && rec.timestamp < from) before = true;
+    }
+
+    // The months of the days, then older ones until one holds a visit before
+    // the first day. The manifest is in pet/month order.
+    std::vector<HistorySample> samples;
+    for (size_t i = _manifest.size(); i-- > 0;) {
+        const ManifestEntry &entry = _manifest[i];
+        if (entry.petId != out.petId() || entry.month > monthOf(to - 1)) continue;
+        if (monthEnd(entry.month) <= from && before) break;
+        samples.clear();
+        if (!readShard(shardPath(entry.petId, entry.month), samples)) continue;
+        for (const HistorySample &sample : samples) {
+            if ((time_t)sample.timestamp >= to) break;
+            out.insert(sample.timestamp, sample.weightGrams, sample.durationSeconds);
+            if ((time_t)sample.timestamp < from) before = true;
+        }
+    }
+    for (const LitterboxRecord &rec : _journal) {
+        if (rec.pet_id == out.petId() && rec.timestamp < to) out.insert(rec.timestamp, rec.weight_grams, rec.duration_seconds);
+    }
+}
+
+void DataManager::setRollupDay(RollupState &state, const DailyRollup &rollup, const BucketCounts &counts) {
+    auto emptyDay = [](uint32_t day) {
+        DailyRollup empty{};
+        empty.day = day;
+        return empty;
+    };
+
+    if (state.days.empty()) {
+        state.firstDay = rollup.day;
+        state.savedDays = 0;
+    } else if (rollup.day < state.firstDay) {
+        // Backfill before the first day shifts every index, so the file is rewritten
+        PsramVector<DailyRollup> lead;
+        for (uint32_t day = rollup.day; day < state.firstDay; day++) lead.push_back(emptyDay(day));
+        state.days.insert(state.days.begin(), lead.begin(), lead.end());
+        state.firstDay = rollup.day;
+        state.savedDays = 0;
+    }
+
+    uint32_t index = rollup.day - state.firstDay;
+    while (state.days.size() <= index) {
+        state.days.push_back(emptyDay(state.firstDay + state.days.size()));
+    }
+    state.days[index] = rollup;
+    state.dirtyFrom = std::min(state.dirtyFrom, index);
+
+    auto changed = std::lower_bound(state.counts.begin(), state.counts.end(), rollup.day,
+                                    [](const std::pair<uint32_t, BucketCounts> &c, uint32_t day) { return c.first < day; });
+    if (changed != state.counts.end() && changed->first == rollup.day) {
+        changed->second = counts;
     } else {
-        Serial.println("[DataManager] Rename failed!");
-        // Note: program leaves the .tmp file there so we can try to recover it next boot
+        state.counts.insert(changed, {rollup.day, counts});
+    }
+}
+
+void DataManager::saveRollups(time_t pruneTimestamp) {
+    uint32_t pruneDay = pruneTimestamp > 0 ? pruneTimestamp / 86400 : 0;
+    for (RollupState &state : _rollups) {
+        // Same slack as the shards get: only trim once a month has gone stale
+        if (!state.days.empty() && state.firstDay + 31 < pruneDay) {
+            uint32_t drop = std::min<uint32_t>(pruneDay - state.firstDay, state.days.size());
+            state.days.erase(state.days.begin(), state.days.begin() + drop);
+            state.firstDay += drop;
+            state.savedDays = 0;
+            state.dirtyFrom = 0;
+        }
+        if (state.days.empty()) continue;
+        if (state.dirtyFrom != UINT32_MAX || state.savedDays == 0) writeRollup(state);
+        if (state.countsRebuilt || !state.counts.empty()) writeBuckets(state);
+    }
+}
+
+bool DataManager::writeRollup(RollupState &state) {
+    String path = rollupPath(state.petId);
+    RollupHeader header = {ROLLUP_MAGIC, ROLLUP_VERSION, sizeof(DailyRollup), state.petId,
+                           state.firstDay, (uint32_t)state.days.size()};
+
+    // Same layout as on the card: rewrite only from the first changed day onwards
+    if (state.savedDays > 0 && _fs->exists(path)) {
+        uint32_t from = std::min(state.dirtyFrom, state.savedDays);
+        File file = _fs->open(path, "r+");
+        if (file) {
+            size_t bytes = (state.days.size() - from) * sizeof(DailyRollup);
+            file.seek(sizeof(RollupHeader) + from * sizeof(DailyRollup));
+            bool ok = file.write((const uint8_t *)&state.days[from], bytes) == bytes;
+            file.seek(0);
+            ok = ok && file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+            file.flush();
+            file.close();
+            if (ok) {
+                state.savedDays = state.days.size();
+                state.dirtyFrom = UINT32_MAX;
+                return true;
+            }
+        }
+        Serial.println("[DataManager] Rollup update failed, rewriting.");
+    }
+
+    // ATOMIC SAVE
+    String tempPath = path + ".tmp";
+    if (_fs->exists(tempPath)) {
+        _fs->remove(tempPath);
+    }
+    File file = _fs->open(tempPath, FILE_WRITE);
+    if (!file) {
+        Serial.println("[DataManager] Failed to open rollup for writing!");
+        return false;
+    }
+    size_t bytes = state.days.size() * sizeof(DailyRollup);
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)state.days.data(), bytes) == bytes;
+    file.flush();
+    file.close();
+    if (!ok) {
+        Serial.println("[DataManager] Rollup write failed!");
+        return false;
+    }
+
+    // Rollups can always be rebuilt from the shards, so a crash here only costs time
+    if (_fs->exists(path)) {
+        _fs->remove(path);
+    }
+    if (!_fs->rename(tempPath, path)) {
+        Serial.println("[DataManager] Rollup rename failed!");
+        return false;
+    }
+    state.savedDays = state.days.size();
+    state.dirtyFrom = UINT32_MAX;
+    return true;
+}
+
+// to += counts * sign, wrapping as the running totals on the card do
+static void addCounts(BucketCounts &to, const BucketCounts &counts, int sign) {
+    for (int b = 0; b < ROLLUP_BUCKETS; b++) {
+        to.duration[b] += sign * counts.duration[b];
+        to.interval[b] += sign * counts.interval[b];
+    }
+}
+
+bool DataManager::writeBuckets(RollupState &state) {
+    String path = bucketsPath(state.petId);
+
+    // The days that did not change are counted from the totals on the card:
+    // the file's header, then its totals over the days still held
+    RollupHeader saved = {};
+    PsramVector<BucketCounts> old;
+    uint32_t oldFirst = 0; // index in the file of old[0]
+    bool inPlace = false;
+    uint32_t from = 0;
+    File file;
+    if (!state.countsRebuilt) {
+        file = _fs->open(path, "r+");
+        bool ok = file && file.read((uint8_t *)&saved, sizeof(saved)) == sizeof(saved) &&
+                  saved.magic == BUCKETS_MAGIC && saved.version == BUCKETS_VERSION &&
+                  saved.entrySize == sizeof(BucketCounts) && saved.petId == state.petId;
+        if (ok) {
+            // Same first day: rewritten in place from the first changed day
+            inPlace = saved.firstDay == state.firstDay && saved.dayCount <= state.days.size();
+            if (inPlace) {
+                from = saved.dayCount;
+                for (const auto &changed : state.counts) {
+                    if (changed.first < state.firstDay) continue;
+                    from = std::min(from, changed.first - state.firstDay);
+                    break;
+                }
+            }
+            int64_t lo = std::max<int64_t>((int64_t)state.firstDay + from - saved.firstDay, 0);
+            int64_t hi = std::min<int64_t>((int64_t)state.firstDay + state.days.size() - saved.firstDay, saved.dayCount);
+            if (lo <= hi) {
+                oldFirst = lo;
+                old.resize(hi - lo + 1);
+                size_t bytes = old.size() * sizeof(BucketCounts);
+                ok = file.seek(sizeof(RollupHeader) + lo * sizeof(BucketCounts)) &&
+                     file.read((uint8_t *)old.data(), bytes) == bytes;
+            }
+        }
+        if (!ok) {
+            // Only the shards can count the other days again
+            Serial.printf("[DataManager] Buckets for pet %d are invalid.\r\n", state.petId);
+            if (file) file.close();
+            rebuildRollup(state);
+            old.clear();
+            inPlace = false;
+            from = 0;
+        }
+    }
+
+    // Totals from `from` on, each day's counts from the card unless it changed
+    uint32_t dayCount = state.days.size();
+    PsramVector<BucketCounts> totals(dayCount + 1 - from);
+    totals[0] = inPlace ? old[0] : BucketCounts{};
+    auto changed = state.counts.begin();
+    for (uint32_t i = from; i < dayCount; i++) {
+        uint32_t day = state.firstDay + i;
+        BucketCounts counts = {};
+        int64_t j = (int64_t)day - saved.firstDay - oldFirst;
+        if (j >= 0 && j + 1 < (int64_t)old.size()) {
+            counts = old[j + 1];
+            addCounts(counts, old[j], -1);
+        }
+        while (changed != state.counts.end() && changed->first < day) changed++;
+        if (changed != state.counts.end() && changed->first == day) counts = changed->second;
+        totals[i - from + 1] = totals[i - from];
+        addCounts(totals[i - from + 1], counts, 1);
+    }
+
+    RollupHeader header = {BUCKETS_MAGIC, BUCKETS_VERSION, sizeof(BucketCounts), state.petId, state.firstDay, dayCount};
+    if (inPlace) {
+        size_t bytes = (totals.size() - 1) * sizeof(BucketCounts);
+        bool ok = file.seek(sizeof(RollupHeader) + (from + 1) * sizeof(BucketCounts)) &&
+                  file.write((const uint8_t *)&totals[1], bytes) == bytes;
+        file.seek(0);
+        ok = ok && file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+        file.flush();
+        file.close();
+        if (ok) {
+            state.counts.clear();
+            return true;
+        }
+        // Part of the totals may be new, so the file is no good to count from
+        Serial.println("[DataManager] Bucket update failed!");
+        _fs->remove(path);
+        return false;
+    }
+    if (file) file.close();
+
+    // ATOMIC SAVE
+    String tempPath = path + ".tmp";
+    if (_fs->exists(tempPath)) {
+        _fs->remove(tempPath);
+    }
+    file = _fs->open(tempPath, FILE_WRITE);
+    if (!file) {
+        Serial.println("[DataManager] Failed to open buckets for writing!");
+        return false;
     }
+    size_t bytes = totals.size() * sizeof(BucketCounts);
+    bool ok = file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              file.write((const uint8_t *)totals.data(), bytes) == bytes;
+    file.flush();
+    file.close();
+    if (!ok) {
+        Serial.println("[DataManager] Bucket write failed!");
+        return false;
+    }
+
+    // Rebuilt from the shards like the rollups, so a crash here only costs time
+    if (_fs->exists(path)) {
+        _fs->remove(path);
+    }
+    if (!_fs->rename(tempPath, path)) {
+        Serial.println("[DataManager] Bucket rename failed!");
+        return false;
+    }
+    state.counts.clear();
+    state.countsRebuilt = false;
+    return true;
+}
+
+bool DataManager::sumBuckets(RollupState &state, uint32_t sinceDay, BucketCounts &sum) {
+    sum = {};
+    if (state.days.empty()) return true;
+    // Changes not on the card yet go out first, so the totals take them in
+    if (state.countsRebuilt || !state.counts.empty()) writeBuckets(state);
+
+    // Two totals, wherever the window starts
+    File file = _fs->open(bucketsPath(state.petId), FILE_READ);
+    if (!file) return false;
+    RollupHeader header;
+    BucketCounts first, last;
+    bool ok = file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == BUCKETS_MAGIC && header.version == BUCKETS_VERSION &&
+              header.entrySize == sizeof(BucketCounts) && header.petId == state.petId;
+    if (ok) {
+        uint32_t start = sinceDay > header.firstDay ? std::min(sinceDay - header.firstDay, header.dayCount) : 0;
+        ok = file.seek(sizeof(RollupHeader) + start * sizeof(BucketCounts)) &&
+             file.read((uint8_t *)&first, sizeof(first)) == sizeof(first) &&
+             file.seek(sizeof(RollupHeader) + header.dayCount * sizeof(BucketCounts)) &&
+             file.read((uint8_t *)&last, sizeof(last)) == sizeof(last);
+    }
+    file.close();
+    if (!ok) return false;
+    sum = last;
+    addCounts(sum, first, -1);
+    return true;
+}
+
+String DataManager::rollupPath(int petId) {
+    char path[40];
+    snprintf(path, sizeof(path), "%s/%d_days.bin", _historyDir, petId);
+    return String(path);
+}
+
+String DataManager::bucketsPath(int petId) {
+    char path[40];
+    snprintf(path, sizeof(path), "%s/%d_buckets.bin", _historyDir, petId);
+    return String(path);
+}
+
+DailyRollup DataManager::aggregateDay(const PetSeries &series, uint32_t day, size_t lo, size_t hi, BucketCounts &counts) {
+    DailyRollup rollup{};
+    counts = {};
+    rollup.day = day;
+    rollup.minWeight = INT32_MAX;
+    rollup.maxWeight = INT32_MIN;
+    for (size_t i = lo; i < hi; i++) {
+        int64_t interval = i > 0 ? (int64_t)(series.timestamp(i) - series.timestamp(i - 1)) : -1;
+        addVisit(rollup, series.weight(i), series.duration(i), interval);
+        addVisit(counts, series.duration(i), interval);
+    }
+    if (rollup.visits == 0) {
+        rollup.minWeight = 0;
+        rollup.maxWeight = 0;
+    }
+    return rollup;
+}
+
+HistorySample DataManager::toSample(const LitterboxRecord &record) {
+    return {(uint32_t)record.timestamp, record.weight_grams, record.duration_seconds};
+}
+
+// Shards are keyed by UTC month as YYYYMM so the layout does not move with the timezone
+uint32_t DataManager::monthOf(time_t ts) {
+    struct tm t;
+    gmtime_r(&ts, &t);
+    return (t.tm_year + 1900) * 100 + (t.tm_mon + 1);
+}
+
+time_t DataManager::monthEnd(uint32_t month) {
+    int year = month / 100;
+    int mon = month % 100 + 1; // first month after this one
+    if (mon > 12) {
+        mon = 1;
+        year++;
+    }
+    // Days from 1970-01-01 to the first of that month (civil-from-days inverse)
+    year -= mon <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yoe = (unsigned)(year - era * 400);
+    unsigned doy = (153 * (mon + (mon > 2 ? -3 : 9)) + 2) / 5;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    long days = (long)era * 146097 + (long)doe - 719468;
+    return (time_t)days * 86400L;
 }
 
 void DataManager::saveStatus(const StatusRecord &status) {
+    _hot.setStatus(status);
+
     JsonDocument doc; 
     JsonObject root = doc.to<JsonObject>();
     root["box_full"] = status.box_full;
@@ -155,7 +1184,7 @@ void DataManager::saveStatus(const StatusRecord &status) {
     root["sand_lack"] = status.sand_lack;
     root["timestamp"] = status.timestamp;
 
-    File file = SD.open(_status_filename, FILE_WRITE);
+    File file = _fs->open(_status_filename, FILE_WRITE);
     if (file) {
         serializeJson(doc, file);
         file.close();
@@ -171,13 +1200,17 @@ void DataManager::saveStatus(const StatusRecord &status) {
     s.timestamp = 0;
     s.device_name = "";
 
-    if (!SD.exists(_status_filename)) {
+    if (_hot.getStatus(s)) {
+        return s;
+    }
+
+    if (!_fs->exists(_status_filename)) {
         Serial.println("[DataManager] No Status file found.");
         return s;
     }
     else Serial.println("[DataManager] Status file loaded");
 
-    File file = SD.open(_status_filename, FILE_READ);
+    File file = _fs->open(_status_filename, FILE_READ);
     if (!file) return s;
 
     JsonDocument doc;
@@ -196,25 +1229,58 @@ void DataManager::saveStatus(const StatusRecord &status) {
     s.litter_percent = root["litter_percent"]; 
     s.sand_lack = root["sand_lack"];
     s.timestamp = root["timestamp"];
+    _hot.setStatus(s);
     return s;
  }
 
-void DataManager::mergeData(PetDataMap &mainData, int petId, const std::vector<LitterboxRecord> &newRecords) {
-    for (const auto &record : newRecords) {
-        mainData[petId][record.timestamp] = record;
+size_t DataManager::mergeData(PetDataMap &mainData, int petId, const std::vector<LitterboxRecord> &newRecords) {
+    // Sorted once, so the merge is a single linear pass. Stable, so of two
+    // copies of one visit the later wins.
+    std::vector<LitterboxRecord> sorted(newRecords);
+    auto byTime = [](const LitterboxRecord &a, const LitterboxRecord &b) { return a.timestamp < b.timestamp; };
+    if (!std::is_sorted(sorted.begin(), sorted.end(), byTime)) {
+        std::stable_sort(sorted.begin(), sorted.end(), byTime);
     }
+
+    // Anything added or changed is queued for the card
+    std::vector<LitterboxRecord> changed;
+    PetSeries &series = mainData[petId];
+    series.merge(sorted.data(), sorted.size(), &changed);
+    if (changed.empty()) return 0;
+
+    updateRollup(series, changed);
+    _pending.insert(_pending.end(), changed.begin(), changed.end());
+    return changed.size();
 }
 
-time_t DataManager::getLatestTimestamp(const PetDataMap &petData) {
+time_t DataManager::getLatestTimestamp() {
     time_t latest = 0;
-    for (auto const &petPair : petData) {
-        const std::map<time_t, LitterboxRecord> &recordsMap = petPair.second;
-        if (!recordsMap.empty()) {
-            time_t petLatest = recordsMap.rbegin()->first;
-            if (petLatest > latest) {
-                latest = petLatest;
-            }
+    if (_hot.getLatestTimestamp(latest)) {
+        return latest;
+    }
+
+    // The manifest is in pet/month order, so each pet's newest shard is the last of its run
+    if (!_manifestLoaded) loadManifest();
+    std::vector<HistorySample> samples;
+    for (size_t i = 0; i < _manifest.size(); i++) {
+        if (i + 1 < _manifest.size() && _manifest[i + 1].petId == _manifest[i].petId) continue;
+        samples.clear();
+        if (readShard(shardPath(_manifest[i].petId, _manifest[i].month), samples) && !samples.empty()) {
+            latest = std::max(latest, (time_t)samples.back().timestamp);
         }
     }
+    loadJournal();
+    for (const LitterboxRecord &rec : _journal) {
+        latest = std::max(latest, rec.timestamp);
+    }
+    _hot.setLatestTimestamp(latest);
     return latest;
+}
+
+bool DataManager::getCachedPets(std::vector<Pet> &pets) {
+    return _hot.getPets(pets);
+}
+
+void DataManager::cachePets(const std::vector<Pet> &pets) {
+    _hot.setPets(pets);
 }
\ No newline at end of file
@@ -3,39 +3,232 @@
 
 #include <Arduino.h>
 #include <FS.h>
-#include <SD.h>
-#include <SPI.h>
 #include <ArduinoJson.h>
+#include <functional>
 #include "SharedTypes.h"
-#include "config.h" 
+#include "HistoryCodec.h"
+#include "RtcCache.h"
+#include "Clock.h"
+#include "config.h"
 
 class DataManager {
 public:
     DataManager();
-    
-    // Initialize SD card using the shared SPI instance
-    bool begin(SPIClass &spi);
-    
-    // Load historical data from SD into the provided map
-    void loadData(PetDataMap &petData);
-    
-    // Save the provided map to SD, pruning old data
-    void saveData(const PetDataMap &petData);
-    
+
+    // Keep history on fs, which must already be mounted: the SD card on
+    // the device, a host directory in the native builds
+    void begin(fs::FS &fs);
+
+    // Load historical data from SD into the provided map, limited to records
+    // at or after `since` and, if petIds is not empty, to those pets. Only
+    // the shards overlapping the window are opened.
+    // Migrates an older single-file history on first run.
+    void loadData(PetDataMap &petData, time_t since = 0, const std::vector<int> &petIds = {});
+
+    // Append records queued by mergeData to the journal as one CRC-framed
+    // batch. Once the journal passes JOURNAL_COMPACT_BYTES it is folded into
+    // the pet/month shards, touching only the shards that changed, and shards
+    // past retention are deleted.
+    void saveData();
+
+    // Stamp that changes whenever saveData writes new history, so anything
+    // rendered from the data can tell whether it is still current.
+    uint32_t getDataVersion();
+
+    // Load the per-day rollups of the given pets (all if empty) for days at
+    // or after `since`, with their buckets summed. A pet without a rollup or
+    // bucket file gets them rebuilt from its shards.
+    void loadRollups(PetRollupMap &rollups, time_t since = 0, const std::vector<int> &petIds = {});
+
     //save latest status for display on plot
     void saveStatus(const StatusRecord &status);
 
     //fetch sotred status info from SD card
+    //served from the RTC cache when it holds one
     StatusRecord getStatus();
 
-    // Merge new records from API into the main map
-    void mergeData(PetDataMap &mainData, int petId, const std::vector<LitterboxRecord> &newRecords);
+    // Pet registry kept in RTC memory across deep sleep. getCachedPets
+    // returns false if the cache does not hold one.
+    bool getCachedPets(std::vector<Pet> &pets);
+    void cachePets(const std::vector<Pet> &pets);
+
+    // Merge new records from API into the main map in one sorted pass.
+    // Records not already present are queued for the next saveData(), and
+    // the daily rollups of the days they touch are recomputed, from the card
+    // where mainData does not hold the whole day and the visit before it.
+    // Returns the number of records that were new or changed.
+    size_t mergeData(PetDataMap &mainData, int petId, const std::vector<LitterboxRecord> &newRecords);
 
-    // Helper to find the most recent timestamp in the existing data
-    time_t getLatestTimestamp(const PetDataMap &petData);
+    // Most recent timestamp stored on the card, from the RTC cache when
+    // known, otherwise from the newest shard of each pet
+    time_t getLatestTimestamp();
 
 private:
-    const char* _filename = "/pet_data.json";
+    // History is sharded into one file per pet per UTC month, /history/<pet>_<YYYYMM>.bin.
+    // Each shard is a ShardHeader followed by a single HistoryCodec block
+    // holding the month's records sorted by timestamp.
+    struct __attribute__((packed)) ShardHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t recordCount;
+        uint32_t oldestTs;
+        uint32_t newestTs;
+        uint32_t blockBytes;
+    };
+
+    // Version 1 layout, used by /pet_data.bin and the first sharded files:
+    // a LogHeader followed by fixed-width LogRecords. Read-only now.
+    struct __attribute__((packed)) LogHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t recordCount;
+        uint32_t oldestTs;
+        uint32_t newestTs;
+    };
+
+    struct __attribute__((packed)) LogRecord {
+        uint32_t timestamp;
+        int32_t petId;
+        int32_t weightGrams;
+        int32_t durationSeconds;
+    };
+
+    // The manifest lists every shard so a load never has to walk the directory
+    struct __attribute__((packed)) ManifestHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t entrySize;
+        uint32_t entryCount;
+        uint32_t dataVersion; // sequence of the last journal frame folded into the shards
+    };
+
+    struct __attribute__((packed)) ManifestEntry {
+        int32_t petId;
+        uint32_t month; // YYYYMM
+        uint32_t recordCount;
+    };
+
+    // Per-pet rollups live in /history/<pet>_days.bin: a RollupHeader followed
+    // by one DailyRollup per day from firstDay, so a changed day is rewritten in place.
+    // Their buckets live in /history/<pet>_buckets.bin, so the daily views do
+    // not read them day by day: the same header, then dayCount + 1 running
+    // totals, each of the BucketCounts of every day before firstDay + i. A
+    // window's counts are the last total less the one at its first day. The
+    // totals wrap at 16 bits, which holds while no window counts 65536 visits
+    // into one bucket.
+    struct __attribute__((packed)) RollupHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t entrySize;
+        int32_t petId;
+        uint32_t firstDay;
+        uint32_t dayCount;
+    };
+
+    // Write-ahead journal, /history/journal.bin: frames appended by saveData,
+    // each a JournalFrame followed by recordCount LogRecords. A torn or
+    // corrupt frame ends the journal; it and anything after it are cut off.
+    struct __attribute__((packed)) JournalFrame {
+        uint32_t magic;
+        uint32_t sequence;
+        uint32_t recordCount;
+        uint32_t crc; // CRC32 over the fields above, then the records
+    };
+
+    // In-memory copy of one pet's rollup file
+    struct RollupState {
+        int petId;
+        uint32_t firstDay;
+        PsramVector<DailyRollup> days; // dense, days[i].day == firstDay + i
+        uint32_t savedDays;            // days on the card with the same firstDay; 0 forces a rewrite
+        uint32_t dirtyFrom;            // first index not yet on the card, UINT32_MAX if clean
+        // Buckets of the days changed since the bucket file was written, by day
+        PsramVector<std::pair<uint32_t, BucketCounts>> counts;
+        bool countsRebuilt;            // counts holds every day, the file is written afresh
+    };
+
+    static const uint32_t LOG_MAGIC = 0x474C4B50; // "PKLG"
+    static const uint16_t LOG_VERSION = 1;
+    static const uint16_t SHARD_VERSION = 2;
+    static const uint32_t MANIFEST_MAGIC = 0x464D4B50; // "PKMF"
+    static const uint16_t MANIFEST_VERSION = 2;
+    static const uint32_t ROLLUP_MAGIC = 0x52444B50; // "PKDR"
+    static const uint16_t ROLLUP_VERSION = 3;
+    static const uint32_t BUCKETS_MAGIC = 0x42444B50; // "PKDB"
+    static const uint16_t BUCKETS_VERSION = 1;
+    static const uint32_t JOURNAL_MAGIC = 0x464A4B50; // "PKJF"
+    static const size_t JOURNAL_COMPACT_BYTES = 16 * 1024;
+
+    bool readHeader(File &file, LogHeader &header);
+    uint32_t readLog(File &file, const std::function<void(const LogRecord &)> &onRecord);
+    // Reads a shard, first promoting a complete .tmp left where it is missing
+    bool readShard(const String &path, std::vector<HistorySample> &samples);
+    bool decodeShard(const String &path, std::vector<HistorySample> &samples);
+    bool writeShard(ManifestEntry &entry, const LitterboxRecord *records, size_t count);
+    void pruneShards(time_t pruneTimestamp);
+    void migrateLegacy(PetDataMap &petData);
+
+    bool loadManifest();
+    bool saveManifest();
+    void rebuildManifest();
+    void sortManifest();
+    ManifestEntry *findShard(int petId, uint32_t month);
+    String shardPath(int petId, uint32_t month);
+
+    void loadJournal();
+    bool appendJournal(const std::vector<LitterboxRecord> &records);
+    void truncateJournal(size_t length);
+    bool compactJournal();
+
+    RollupState &rollupFor(int petId);
+    bool readRollup(RollupState &state);
+    void rebuildRollup(RollupState &state);
+    void updateRollup(const PetSeries &series, const std::vector<LitterboxRecord> &changed);
+    void readDays(PetSeries &out, uint32_t first, uint32_t last);
+    void setRollupDay(RollupState &state, const DailyRollup &day, const BucketCounts &counts);
+    void saveRollups(time_t pruneTimestamp);
+    bool writeRollup(RollupState &state);
+    bool writeBuckets(RollupState &state);
+    bool sumBuckets(RollupState &state, uint32_t sinceDay, BucketCounts &sum);
+    String rollupPath(int petId);
+    String bucketsPath(int petId);
+
+    static HistorySample toSample(const LitterboxRecord &record);
+    static DailyRollup aggregateDay(const PetSeries &series, uint32_t day, size_t lo, size_t hi, BucketCounts &counts);
+    static uint32_t monthOf(time_t ts);
+    static time_t monthEnd(uint32_t month);
+
+    fs::FS *_fs = nullptr;
+
+    std::vector<ManifestEntry> _manifest;
+    bool _manifestLoaded = false;
+    uint32_t _dataVersion = 0;
+
+    RtcCache _hot;
+
+    // Where the last loadData() of every pet started; -1 if none has run
+    time_t _loadedSince = -1;
+
+    // Journal contents, read and checked once per wake
+    std::vector<LitterboxRecord> _journal;
+    bool _journalLoaded = false;
+    uint32_t _journalSeq = 0;
+    size_t _journalBytes = 0;
+
+    std::vector<RollupState> _rollups;
+
+    // Records merged since the last save, waiting to be written
+    std::vector<LitterboxRecord> _pending;
+
+    const char* _historyDir = "/history";
+    const char* _manifestFilename = "/history/manifest.bin";
+    const char* _manifestTempFilename = "/history/manifest.tmp";
+    const char* _journalFilename = "/history/journal.bin";
+    const char* _journalTempFilename = "/history/journal.tmp";
+    const char* _legacyLogFilename = "/pet_data.bin";
+    const char* _legacyFilename = "/pet_data.json";
     const char* _status_filename = "/status.json";
 };
 
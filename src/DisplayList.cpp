@@ -0,0 +1,311 @@
+#include "DisplayList.h"
+#include <algorithm>
+
+DisplayList::DisplayList(int16_t w, int16_t h, int16_t bandRows)
+    : PlotSurface(w, h), _bandRows(bandRows), _bandCount((h + bandRows - 1) / bandRows)
+{
+    if (_bandCount > 1)
+        _bands.resize(_bandCount);
+}
+
+void DisplayList::clear()
+{
+    _ops.clear();
+    _stamps.clear();
+    _fonts.clear();
+    _colors.clear();
+    _sprites.clear();
+    for (auto &band : _bands)
+        band.clear();
+}
+
+size_t DisplayList::bytes() const
+{
+    size_t total = _ops.size() * sizeof(Op) + _stamps.size() * sizeof(uint16_t) + _sprites.size() * sizeof(Sprite);
+    for (const auto &band : _bands)
+        total += band.size() * sizeof(uint32_t);
+    return total;
+}
+
+void DisplayList::add(const Op &op, int16_t top, int16_t bottom)
+{
+    top = std::max<int16_t>(top, 0);
+    bottom = std::min<int16_t>(bottom, HEIGHT - 1);
+    if (bottom < top)
+        return;
+    uint32_t index = _ops.size();
+    _ops.push_back(op);
+    if (_bandCount > 1)
+    {
+        for (int16_t band = top / _bandRows; band <= bottom / _bandRows; band++)
+            _bands[band].push_back(index);
+    }
+}
+
+// Columns dx to dx + w - 1 of a stamp row, clipped to it
+static uint16_t stampColumns(int16_t dx, int16_t w)
+{
+    int16_t c0 = std::max<int16_t>(dx, 0), c1 = std::min<int16_t>(dx + w, 16);
+    if (c1 <= c0)
+        return 0;
+    return (0xFFFFu >> c0) & ~(0xFFFFu >> c1);
+}
+
+bool DisplayList::stamp(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    if (w > STAMP_SIZE / 2 || h > STAMP_SIZE / 2)
+        return false;
+
+    // Into a recent stamp of the same color, unless one recorded after it
+    // already covers part of the rectangle
+    size_t first = _ops.size() > STAMP_LOOKBACK ? _ops.size() - STAMP_LOOKBACK : 0;
+    for (size_t i = _ops.size(); i-- > first;)
+    {
+        const Op &op = _ops[i];
+        if (op.type != OP_STAMP)
+            break;
+        int16_t dx = x - op.x, dy = y - op.y;
+        uint16_t columns = stampColumns(dx, w);
+        uint16_t *rows = &_stamps[stampIndex(op) * STAMP_SIZE];
+        bool inside = dx >= 0 && dy >= 0 && dx + w <= STAMP_SIZE && dy + h <= STAMP_SIZE;
+        if (inside && op.color == color)
+        {
+            for (int16_t row = dy; row < dy + h; row++)
+                rows[row] |= columns;
+            return true;
+        }
+        bool covered = false;
+        for (int16_t row = std::max<int16_t>(dy, 0); row < std::min<int16_t>(dy + h, STAMP_SIZE); row++)
+            covered |= (rows[row] & columns) != 0;
+        if (covered)
+            break;
+    }
+
+    uint32_t index = _stamps.size() / STAMP_SIZE;
+    _stamps.resize(_stamps.size() + STAMP_SIZE, 0);
+    int16_t sx = x + w / 2 - STAMP_SIZE / 2, sy = y + h / 2 - STAMP_SIZE / 2;
+    uint16_t columns = stampColumns(x - sx, w);
+    for (int16_t row = y - sy; row < y - sy + h; row++)
+        _stamps[index * STAMP_SIZE + row] = columns;
+    add({OP_STAMP, 0, color, sx, sy, (int16_t)(index & 0xFFFF), (int16_t)(index >> 16)}, sy, sy + STAMP_SIZE - 1);
+    return true;
+}
+
+void DisplayList::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (_inGlyph || x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT)
+        return;
+    stamp(x, y, 1, 1, color);
+}
+
+// The spans below are the pixels Adafruit_GFX's own line-based versions
+// set, odd ones for zero and negative lengths included, so a replayed list
+// matches drawing straight onto the canvas
+void DisplayList::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    if (_inGlyph)
+        return;
+    int16_t y0 = std::min<int16_t>(y, y + h - 1), y1 = std::max<int16_t>(y, y + h - 1);
+    if (!stamp(x, y0, 1, y1 - y0 + 1, color))
+        add({OP_RECT, 0, color, x, y0, 1, (int16_t)(y1 - y0 + 1)}, y0, y1);
+}
+
+void DisplayList::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    if (_inGlyph)
+        return;
+    int16_t x0 = std::min<int16_t>(x, x + w - 1), x1 = std::max<int16_t>(x, x + w - 1);
+    if (!stamp(x0, y, x1 - x0 + 1, 1, color))
+        add({OP_RECT, 0, color, x0, y, (int16_t)(x1 - x0 + 1), 1}, y, y);
+}
+
+void DisplayList::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    if (_inGlyph || w <= 0)
+        return;
+    // One vertical line per column
+    int16_t y0 = std::min<int16_t>(y, y + h - 1), y1 = std::max<int16_t>(y, y + h - 1);
+    if (!stamp(x, y0, w, y1 - y0 + 1, color))
+        add({OP_RECT, 0, color, x, y0, w, (int16_t)(y1 - y0 + 1)}, y0, y1);
+}
+
+void DisplayList::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    if (_inGlyph)
+        return;
+    add({OP_LINE, 0, color, x0, y0, x1, y1}, std::min(y0, y1), std::max(y0, y1));
+}
+
+size_t DisplayList::write(uint8_t c)
+{
+    // Adafruit_GFX places the glyph, wrapping and advancing the cursor, with
+    // its pixels dropped; the glyph is then recorded where it landed
+    _inGlyph = true;
+    Adafruit_GFX::write(c);
+    _inGlyph = false;
+    if (c == '\n' || c == '\r')
+        return 1;
+
+    int16_t x = cursor_x, y = cursor_y, top, bottom;
+    if (gfxFont == nullptr)
+    {
+        x -= textsize_x * 6;
+        top = y;
+        bottom = y + textsize_y * 8 - 1;
+    }
+    else
+    {
+        if (c < gfxFont->first || c > gfxFont->last)
+            return 1;
+        const GFXglyph &glyph = gfxFont->glyph[c - gfxFont->first];
+        if (glyph.width == 0 || glyph.height == 0)
+            return 1;
+        x -= glyph.xAdvance * textsize_x;
+        top = y + glyph.yOffset * textsize_y;
+        bottom = top + glyph.height * textsize_y - 1;
+    }
+    add({OP_CHAR, (uint8_t)(textsize_x | textsize_y << 4), textcolor, x, y,
+         (int16_t)(c | fontIndex(gfxFont) << 8), (int16_t)textbgcolor},
+        top, bottom);
+    return 1;
+}
+
+void DisplayList::fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2)
+{
+    if (w <= 0 || h <= 0)
+        return;
+    add({OP_CHECKER, colorIndex(color2), color1, x0, y0, w, h}, y0, y0 + h - 1);
+}
+
+void DisplayList::fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color)
+{
+    if (w <= 0 || h <= 0 || spacing <= 0)
+        return;
+    if (spacing > 0xFF)
+    {
+        PlotSurface::fillHatch(x0, y0, w, h, spacing, color);
+        return;
+    }
+    add({OP_HATCH, (uint8_t)spacing, color, x0, y0, w, h}, y0, y0 + h - 1);
+}
+
+void DisplayList::drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off)
+{
+    if (on == 0 || length <= 0)
+        return;
+    add({OP_HDASH, 0, color, x0, y0, length, (int16_t)(on | off << 8)}, y0, y0);
+}
+
+void DisplayList::drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off)
+{
+    if (on == 0 || length <= 0)
+        return;
+    add({OP_VDASH, 0, color, x0, y0, length, (int16_t)(on | off << 8)}, y0, y0 + length - 1);
+}
+
+void DisplayList::drawSprite(int16_t x, int16_t y, const Sprite &sprite)
+{
+    if (_inGlyph || sprite.colors == 0)
+        return;
+    add({OP_SPRITE, 0, 0, x, y, (int16_t)spriteIndex(sprite), 0}, y + sprite.y, y + sprite.y + sprite.h - 1);
+}
+
+uint8_t DisplayList::fontIndex(const GFXfont *font)
+{
+    for (size_t i = 0; i < _fonts.size(); i++)
+    {
+        if (_fonts[i] == font)
+            return i;
+    }
+    _fonts.push_back(font);
+    return _fonts.size() - 1;
+}
+
+uint8_t DisplayList::colorIndex(uint16_t color)
+{
+    for (size_t i = 0; i < _colors.size(); i++)
+    {
+        if (_colors[i] == color)
+            return i;
+    }
+    _colors.push_back(color);
+    return _colors.size() - 1;
+}
+
+uint16_t DisplayList::spriteIndex(const Sprite &sprite)
+{
+    for (size_t i = 0; i < _sprites.size(); i++)
+    {
+        if (_sprites[i] == sprite)
+            return i;
+    }
+    _sprites.push_back(sprite);
+    return _sprites.size() - 1;
+}
+
+void DisplayList::replay(PlotSurface &target, int16_t band) const
+{
+    int16_t top = band * _bandRows;
+    int16_t bottom = std::min<int16_t>(top + _bandRows, HEIGHT) - 1;
+    if (_bandCount == 1)
+    {
+        for (const Op &op : _ops)
+            draw(target, op, top, bottom);
+        return;
+    }
+    for (uint32_t index : _bands[band])
+        draw(target, _ops[index], top, bottom);
+}
+
+void DisplayList::draw(PlotSurface &target, const Op &op, int16_t top, int16_t bottom) const
+{
+    switch (op.type)
+    {
+    case OP_RECT:
+    {
+        // Clipped to the band; a line or glyph is left to the target's own clipping
+        int16_t y0 = std::max(op.y, top), y1 = std::min<int16_t>(op.y + op.b - 1, bottom);
+        if (y1 >= y0)
+            target.fillRect(op.x, y0, op.a, y1 - y0 + 1, op.color);
+        break;
+    }
+    case OP_LINE:
+        target.drawLine(op.x, op.y, op.a, op.b, op.color);
+        break;
+    case OP_CHAR:
+        target.setFont(_fonts[(uint16_t)op.a >> 8]);
+        target.drawChar(op.x, op.y, op.a & 0xFF, op.color, (uint16_t)op.b, op.size & 0x0F, op.size >> 4);
+        break;
+    case OP_STAMP:
+    {
+        const uint16_t *rows = &_stamps[stampIndex(op) * STAMP_SIZE];
+        for (int16_t dy = 0; dy < STAMP_SIZE; dy++)
+        {
+            int16_t y = op.y + dy;
+            if (y < top || y > bottom || rows[dy] == 0)
+                continue;
+            for (int16_t dx = 0; dx < STAMP_SIZE; dx++)
+            {
+                if (rows[dy] & (0x8000 >> dx))
+                    target.drawPixel(op.x + dx, y, op.color);
+            }
+        }
+        break;
+    }
+    case OP_CHECKER:
+        target.fillChecker(op.x, op.y, op.a, op.b, op.color, _colors[op.size]);
+        break;
+    case OP_HATCH:
+        target.fillHatch(op.x, op.y, op.a, op.b, op.size, op.color);
+        break;
+    case OP_HDASH:
+        target.drawDashedHLine(op.x, op.y, op.a, op.color, op.b & 0xFF, (uint16_t)op.b >> 8);
+        break;
+    case OP_VDASH:
+        target.drawDashedVLine(op.x, op.y, op.a, op.color, op.b & 0xFF, (uint16_t)op.b >> 8);
+        break;
+    case OP_SPRITE:
+        target.drawSprite(op.x, op.y, _sprites[(uint16_t)op.a]);
+        break;
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include <vector>
+#include "PetHistory.h"
+#include "PlotSurface.h"
+
+/**
+ * @brief Drawing surface that records primitives instead of pixels.
+ *
+ * The widgets lay out and draw into the list once; replay() then draws one
+ * band of rows of it onto a FrameCanvas, so a frame rendered a page at a
+ * time does not run the data through the widgets again for every page.
+ * Rectangles, diagonal lines, glyphs, pattern fills, dashed lines and
+ * sprites are kept as single entries; pixels
+ * and rectangles up to 8x8 are gathered into 16x16 stamps. Each entry is
+ * filed under every band it touches, and replay() only visits the entries
+ * of its band.
+ */
+class DisplayList : public PlotSurface {
+public:
+    DisplayList(int16_t w, int16_t h, int16_t bandRows);
+
+    void clear();
+    void replay(PlotSurface &target, int16_t band) const;
+
+    int16_t bandCount() const { return _bandCount; }
+    size_t entries() const { return _ops.size(); }
+    size_t bytes() const;
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override;
+    size_t write(uint8_t c) override;
+    using Print::write;
+
+    void fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2) override;
+    void fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color) override;
+    void drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off) override;
+    void drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off) override;
+    void drawSprite(int16_t x, int16_t y, const Sprite &sprite) override;
+
+private:
+    enum OpType : uint8_t { OP_RECT, OP_LINE, OP_CHAR, OP_STAMP, OP_CHECKER, OP_HATCH, OP_HDASH, OP_VDASH, OP_SPRITE };
+
+    // RECT: a, b = w, h. LINE: a, b = x1, y1. CHAR: a = char | font << 8,
+    // b = background, size = x | y << 4. STAMP: a, b = low, high half of
+    // the stamp index. CHECKER: a, b = w, h, size = color2 index. HATCH:
+    // a, b = w, h, size = spacing. HDASH, VDASH: a = length, b = on | off << 8.
+    // SPRITE: a = sprite index.
+    struct Op {
+        uint8_t type;
+        uint8_t size;
+        uint16_t color;
+        int16_t x, y;
+        int16_t a, b;
+    };
+
+    static const int16_t STAMP_SIZE = 16;
+    // Stamps at the end of the list a pixel may still be added to
+    static const size_t STAMP_LOOKBACK = 8;
+
+    PsramVector<Op> _ops;
+    PsramVector<uint16_t> _stamps; // STAMP_SIZE rows per stamp, leftmost pixel in bit 15
+    std::vector<const GFXfont *> _fonts;
+    std::vector<uint16_t> _colors; // second colors of checker fills
+    std::vector<Sprite> _sprites;  // copies, as the widget's go with it
+    std::vector<PsramVector<uint32_t>> _bands; // entries per band, when there is more than one
+    int16_t _bandRows;
+    int16_t _bandCount;
+    bool _inGlyph = false;
+
+    void add(const Op &op, int16_t top, int16_t bottom);
+    bool stamp(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void draw(PlotSurface &target, const Op &op, int16_t top, int16_t bottom) const;
+    uint8_t fontIndex(const GFXfont *font);
+    uint8_t colorIndex(uint16_t color);
+    uint16_t spriteIndex(const Sprite &sprite);
+    static uint32_t stampIndex(const Op &op) { return (uint16_t)op.a | (uint32_t)(uint16_t)op.b << 16; }
+};
+
+#endif
@@ -0,0 +1,308 @@
+#include "FrameCanvas.h"
+#if (EPD_SELECT == 1002)
+#include <GxEPD2_7C.h>
+#elif (EPD_SELECT == 1001)
+#include <GxEPD2_BW.h>
+#endif
+#include <string.h>
+#include <algorithm>
+
+#if (EPD_SELECT == 1002)
+static const int PIXELS_PER_BYTE = 2;
+#else
+static const int PIXELS_PER_BYTE = 8;
+#endif
+static const int BITS_PER_PIXEL = 8 / PIXELS_PER_BYTE;
+static const int BYTE_SHIFT = PIXELS_PER_BYTE == 8 ? 3 : 1; // x >> BYTE_SHIFT is the byte of x
+
+// Pixels at even x within a buffer byte
+static const uint8_t EVEN_PIXELS = PIXELS_PER_BYTE == 8 ? 0xAA : 0xF0;
+
+FrameCanvas::FrameCanvas(int16_t w, int16_t h)
+    : FrameCanvas(w, h, h) {}
+
+FrameCanvas::FrameCanvas(int16_t w, int16_t h, int16_t rows)
+    : PlotSurface(w, h), _buffer((size_t)w * rows / PIXELS_PER_BYTE), _rows(rows) {}
+
+void FrameCanvas::setBand(int16_t top)
+{
+    _top = top;
+    _rows = std::min<int16_t>(_buffer.size() / rowBytes(), HEIGHT - top);
+}
+
+size_t FrameCanvas::rowBytes() const
+{
+    return (size_t)WIDTH / PIXELS_PER_BYTE;
+}
+
+void FrameCanvas::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+#ifdef FRAME_CANVAS_STATS
+    _pixelCalls++;
+#endif
+    plot(x, y, fillByte(color));
+}
+
+// Spans below set the pixels Adafruit_GFX's own line-based versions do,
+// zero and negative lengths included
+
+void FrameCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color)
+{
+    int16_t y0 = std::min<int16_t>(y, y + h - 1), y1 = std::max<int16_t>(y, y + h - 1);
+    if (x < 0 || x >= WIDTH)
+        return;
+    y0 = std::max<int16_t>(y0 - _top, 0);
+    y1 = std::min<int16_t>(y1 - _top, _rows - 1);
+    if (y1 < y0)
+        return;
+    uint8_t mask = pixelMask(x), pattern = fillByte(color) & mask;
+    uint8_t *p = &_buffer[(size_t)y0 * rowBytes() + x / PIXELS_PER_BYTE];
+    for (int16_t row = y0; row <= y1; row++, p += rowBytes())
+        *p = (*p & ~mask) | pattern;
+}
+
+void FrameCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color)
+{
+    fillSpan(std::min<int16_t>(x, x + w - 1), std::max<int16_t>(x, x + w - 1), y, fillByte(color));
+}
+
+void FrameCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+    if (w <= 0)
+        return;
+    int16_t y0 = std::min<int16_t>(y, y + h - 1), y1 = std::max<int16_t>(y, y + h - 1);
+    y0 = std::max(y0, _top);
+    y1 = std::min<int16_t>(y1, _top + _rows - 1);
+    uint8_t pattern = fillByte(color);
+    for (int16_t row = y0; row <= y1; row++)
+        fillSpan(x, x + w - 1, row, pattern);
+}
+
+void FrameCanvas::fillScreen(uint16_t color)
+{
+    memset(_buffer.data(), fillByte(color), bufferSize());
+}
+
+void FrameCanvas::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color)
+{
+    line(x0, y0, x1, y1, fillByte(color));
+}
+
+void FrameCanvas::fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2)
+{
+    if (w <= 0 || h <= 0)
+        return;
+    uint8_t fill1 = fillByte(color1), fill2 = fillByte(color2);
+    // color1 on even x in one row, odd x in the next
+    uint8_t evenRow = (fill1 & EVEN_PIXELS) | (fill2 & ~EVEN_PIXELS);
+    uint8_t oddRow = (fill1 & ~EVEN_PIXELS) | (fill2 & EVEN_PIXELS);
+    int16_t top = std::max(y0, _top);
+    int16_t bottom = std::min<int16_t>(y0 + h - 1, _top + _rows - 1);
+    for (int16_t y = top; y <= bottom; y++)
+        fillSpan(x0, x0 + w - 1, y, ((x0 + y - y0) & 1) ? evenRow : oddRow);
+}
+
+void FrameCanvas::fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color)
+{
+    if (w <= 0 || h <= 0 || spacing <= 0)
+        return;
+    if (y0 + h <= _top || y0 >= _top + _rows)
+        return;
+    uint8_t pattern = fillByte(color);
+    // The same lines as PlotSurface::fillHatch
+    for (int16_t k = spacing; k < w + h; k += spacing)
+    {
+        int16_t x1 = std::max(0, k - h);
+        int16_t x2 = std::min(w, k) - 1;
+        line(x0 + x1, y0 + k - x1 - 1, x0 + x2, y0 + k - x2, pattern);
+    }
+}
+
+void FrameCanvas::drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off)
+{
+    if (on == 0 || y0 < _top || y0 >= _top + _rows)
+        return;
+    uint8_t pattern = fillByte(color);
+    for (int16_t i = 0; i < length; i += on + off)
+        fillSpan(x0 + i, x0 + std::min<int16_t>(i + on, length) - 1, y0, pattern);
+}
+
+void FrameCanvas::drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off)
+{
+    if (on == 0)
+        return;
+    uint8_t pattern = fillByte(color);
+    int16_t top = std::max(y0, _top);
+    int16_t bottom = std::min<int16_t>(y0 + length - 1, _top + _rows - 1);
+    for (int16_t y = top; y <= bottom; y++)
+    {
+        if ((y - y0) % (on + off) < on)
+            plot(x0, y, pattern);
+    }
+}
+
+void FrameCanvas::drawSprite(int16_t x, int16_t y, const Sprite &sprite)
+{
+    x += sprite.x;
+    y += sprite.y;
+    int16_t top = std::max(y, _top);
+    int16_t bottom = std::min<int16_t>(y + sprite.h - 1, _top + _rows - 1);
+    // The sprite's columns from the first pixel of x's byte on, MSB first
+    int16_t first = x >> BYTE_SHIFT;
+    int shift = 16 - (x & (PIXELS_PER_BYTE - 1));
+    int16_t bytes = ((x & (PIXELS_PER_BYTE - 1)) + sprite.w + PIXELS_PER_BYTE - 1) / PIXELS_PER_BYTE;
+    int16_t lo = std::max<int16_t>(first, 0) - first;
+    int16_t hi = std::min<int16_t>(first + bytes, rowBytes()) - first;
+
+    for (uint8_t c = 0; c < sprite.colors; c++)
+    {
+        uint8_t pattern = fillByte(sprite.color[c]);
+        for (int16_t row = top; row <= bottom; row++)
+        {
+            uint32_t bits = (uint32_t)sprite.rows[c][row - y] << shift;
+            if (bits == 0)
+                continue;
+            uint8_t *p = &_buffer[(size_t)(row - _top) * rowBytes() + first];
+            for (int16_t i = lo; i < hi; i++)
+            {
+                uint8_t mask = byteMask(bits >> (32 - PIXELS_PER_BYTE * (i + 1)));
+                p[i] = (p[i] & ~mask) | (pattern & mask);
+            }
+        }
+    }
+}
+
+uint8_t FrameCanvas::byteMask(uint32_t pixels)
+{
+#if (EPD_SELECT == 1002)
+    static const uint8_t NIBBLES[] = {0x00, 0x0F, 0xF0, 0xFF};
+    return NIBBLES[pixels & 0x03];
+#else
+    return pixels & 0xFF;
+#endif
+}
+
+uint8_t FrameCanvas::pixelMask(int16_t x)
+{
+    int shift = (PIXELS_PER_BYTE - 1 - x % PIXELS_PER_BYTE) * BITS_PER_PIXEL;
+    return ((1 << BITS_PER_PIXEL) - 1) << shift;
+}
+
+void FrameCanvas::plot(int16_t x, int16_t y, uint8_t pattern)
+{
+    y -= _top;
+    if (x < 0 || y < 0 || x >= WIDTH || y >= _rows)
+        return;
+    uint8_t mask = pixelMask(x);
+    uint8_t &b = _buffer[(size_t)y * rowBytes() + x / PIXELS_PER_BYTE];
+    b = (b & ~mask) | (pattern & mask);
+}
+
+void FrameCanvas::fillSpan(int16_t x0, int16_t x1, int16_t y, uint8_t pattern)
+{
+    y -= _top;
+    x0 = std::max<int16_t>(x0, 0);
+    x1 = std::min<int16_t>(x1, WIDTH - 1);
+    if (y < 0 || y >= _rows || x1 < x0)
+        return;
+
+    uint8_t *row = &_buffer[(size_t)y * rowBytes()];
+    int16_t b0 = x0 / PIXELS_PER_BYTE, b1 = x1 / PIXELS_PER_BYTE;
+    // Pixels from x0 to the end of its byte, and from the start of x1's byte to x1
+    uint8_t first = 0xFF >> (x0 % PIXELS_PER_BYTE * BITS_PER_PIXEL);
+    uint8_t last = 0xFF << ((PIXELS_PER_BYTE - 1 - x1 % PIXELS_PER_BYTE) * BITS_PER_PIXEL);
+    if (b0 == b1)
+    {
+        first &= last;
+        row[b0] = (row[b0] & ~first) | (pattern & first);
+        return;
+    }
+    row[b0] = (row[b0] & ~first) | (pattern & first);
+    memset(row + b0 + 1, pattern, b1 - b0 - 1);
+    row[b1] = (row[b1] & ~last) | (pattern & last);
+}
+
+// Adafruit_GFX::writeLine, plotting straight into the buffer
+void FrameCanvas::line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t pattern)
+{
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep)
+    {
+        std::swap(x0, y0);
+        std::swap(x1, y1);
+    }
+    if (x0 > x1)
+    {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+    }
+
+    int16_t dx = x1 - x0;
+    int16_t dy = abs(y1 - y0);
+    int16_t err = dx / 2;
+    int16_t ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; x0++)
+    {
+        if (steep)
+            plot(y0, x0, pattern);
+        else
+            plot(x0, y0, pattern);
+        err -= dy;
+        if (err < 0)
+        {
+            y0 += ystep;
+            err += dx;
+        }
+    }
+}
+
+uint8_t FrameCanvas::fillByte(uint16_t color)
+{
+    uint8_t pv = nativeColor(color);
+#if (EPD_SELECT == 1002)
+    return (pv << 4) | pv;
+#else
+    return pv ? 0xFF : 0x00;
+#endif
+}
+
+uint8_t FrameCanvas::nativeColor(uint16_t color)
+{
+#if (EPD_SELECT == 1002)
+    switch (color)
+    {
+    case GxEPD_BLACK:
+        return 0x00;
+    case GxEPD_WHITE:
+        return 0x01;
+    case GxEPD_GREEN:
+        return 0x02;
+    case GxEPD_BLUE:
+        return 0x03;
+    case GxEPD_RED:
+        return 0x04;
+    case GxEPD_YELLOW:
+        return 0x05;
+    case GxEPD_ORANGE:
+        return 0x06;
+    }
+    // Anything else goes to the nearest panel color by channel thresholds
+    bool red = (color & 0xF800) >= 0x8000;
+    bool green = (color & 0x07E0) >= 0x0400;
+    bool blue = (color & 0x001F) >= 0x0010;
+    if (red && green && blue)
+        return 0x01;
+    if (red && green)
+        return 0x05;
+    if (red)
+        return 0x04;
+    if (green)
+        return 0x02;
+    if (blue)
+        return 0x03;
+    return 0x00;
+#else
+    // Only white stays white; every other color is drawn black
+    return color == GxEPD_WHITE ? 1 : 0;
+#endif
+}
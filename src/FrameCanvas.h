@@ -0,0 +1,85 @@
+#ifndef FRAME_CANVAS_H
+#define FRAME_CANVAS_H
+
+#include "config.h"
+#include "PlotSurface.h"
+#include "PetHistory.h"
+
+/**
+ * @brief Full-screen drawing surface in the panel's own buffer format.
+ *
+ * The finished frame can be written to the card and later sent to the panel
+ * byte for byte, without drawing anything.
+ * E1001: 1 bit per pixel, MSB first, set = white (as GxEPD2_BW).
+ * E1002: 4 bits per pixel, high nibble first, GxEPD2_7C color codes.
+ * Only rotation 0 is supported.
+ *
+ * With fewer rows than the panel has, the canvas holds one band of them at
+ * a time (see setBand) and drops whatever falls outside it; coordinates
+ * stay those of the whole panel.
+ *
+ * Lines, rectangles, pattern fills, dashes and sprites are written
+ * straight into the buffer a byte or a row span at a time; only single
+ * pixels and text go through drawPixel.
+ */
+class FrameCanvas : public PlotSurface {
+public:
+    FrameCanvas(int16_t w, int16_t h);
+    FrameCanvas(int16_t w, int16_t h, int16_t rows);
+
+    // Hold the rows from top on, as many as fit and the panel has. The
+    // buffer is left as it was.
+    void setBand(int16_t top);
+    int16_t bandTop() const { return _top; }
+    int16_t bandRows() const { return _rows; }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+    void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) override;
+
+    void fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2) override;
+    void fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color) override;
+    void drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off) override;
+    void drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off) override;
+    void drawSprite(int16_t x, int16_t y, const Sprite &sprite) override;
+
+    uint8_t *buffer() { return _buffer.data(); }
+    const uint8_t *buffer() const { return _buffer.data(); }
+    // The rows of the current band
+    size_t bufferSize() const { return (size_t)_rows * rowBytes(); }
+    size_t rowBytes() const;
+
+#ifdef FRAME_CANVAS_STATS
+    // drawPixel calls since construction or the last reset, for the native harness
+    uint32_t pixelCalls() const { return _pixelCalls; }
+    void resetStats() { _pixelCalls = 0; }
+#endif
+
+private:
+    PsramVector<uint8_t> _buffer;
+    int16_t _top = 0;
+    int16_t _rows;
+#ifdef FRAME_CANVAS_STATS
+    uint32_t _pixelCalls = 0;
+#endif
+
+    // Panel value for an RGB565 color, matching what GxEPD2 would store
+    static uint8_t nativeColor(uint16_t color);
+    // A whole buffer byte of that color
+    static uint8_t fillByte(uint16_t color);
+
+    // The pixel bits of x in its buffer byte
+    static uint8_t pixelMask(int16_t x);
+    // The bits of a buffer byte for one bit per pixel, first pixel in the MSB
+    static uint8_t byteMask(uint32_t pixels);
+    // Panel pixels, clipped to the panel and the band; the pattern byte
+    // holds the value for each pixel of a buffer byte
+    void plot(int16_t x, int16_t y, uint8_t pattern);
+    void fillSpan(int16_t x0, int16_t x1, int16_t y, uint8_t pattern);
+    void line(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint8_t pattern);
+};
+
+#endif
@@ -0,0 +1,114 @@
+#include "HistoryCodec.h"
+
+namespace {
+
+    void putVarint(std::vector<uint8_t> &out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back((uint8_t)v);
+    }
+
+    bool getVarint(const uint8_t *&p, const uint8_t *end, uint64_t &v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t b = *p++;
+            v |= (uint64_t)(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // 64-bit zigzag, so a delta-of-delta of two 32-bit deltas never overflows
+    inline uint64_t zigzag64(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+    inline int64_t unzigzag64(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+    bool decodeColumns(const uint8_t *&p, const uint8_t *end, HistorySample *samples, size_t count) {
+        uint64_t v;
+
+        int64_t ts = 0, delta = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!getVarint(p, end, v)) return false;
+            if (i == 0) {
+                ts = (int64_t)v;
+            } else {
+                if (i == 1) delta = unzigzag64(v);
+                else delta += unzigzag64(v);
+                ts += delta;
+            }
+            samples[i].timestamp = (uint32_t)ts;
+        }
+
+        int32_t weight = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!getVarint(p, end, v)) return false;
+            // Unsigned add: deltas were taken modulo 2^32 on the way in
+            weight = (int32_t)((uint32_t)weight + (uint32_t)HistoryCodec::unzigzag((uint32_t)v));
+            samples[i].weightGrams = weight;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (!getVarint(p, end, v)) return false;
+            samples[i].durationSeconds = (int32_t)(uint32_t)v;
+        }
+        return true;
+    }
+
+}
+
+size_t HistoryCodec::maxBlockSize(size_t count) {
+    // count, then at most 10 bytes per timestamp and 5 per weight/duration
+    return 10 + count * 20;
+}
+
+size_t HistoryCodec::encodeBlock(const HistorySample *samples, size_t count, std::vector<uint8_t> &out) {
+    size_t start = out.size();
+    out.reserve(start + maxBlockSize(count));
+    putVarint(out, count);
+
+    int64_t prevTs = 0, prevDelta = 0;
+    for (size_t i = 0; i < count; i++) {
+        int64_t ts = samples[i].timestamp;
+        if (i == 0) {
+            putVarint(out, (uint64_t)ts);
+        } else {
+            int64_t delta = ts - prevTs;
+            if (i == 1) putVarint(out, zigzag64(delta));
+            else putVarint(out, zigzag64(delta - prevDelta));
+            prevDelta = delta;
+        }
+        prevTs = ts;
+    }
+
+    int32_t prevWeight = 0;
+    for (size_t i = 0; i < count; i++) {
+        putVarint(out, zigzag((int32_t)((uint32_t)samples[i].weightGrams - (uint32_t)prevWeight)));
+        prevWeight = samples[i].weightGrams;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        putVarint(out, (uint32_t)samples[i].durationSeconds);
+    }
+
+    return out.size() - start;
+}
+
+size_t HistoryCodec::decodeBlock(const uint8_t *data, size_t length, std::vector<HistorySample> &out) {
+    const uint8_t *p = data;
+    const uint8_t *end = data + length;
+    uint64_t v;
+
+    if (!getVarint(p, end, v)) return 0;
+    size_t count = (size_t)v;
+    // Every sample needs at least three bytes, which bounds a corrupt count
+    if (count > length) return 0;
+
+    size_t base = out.size();
+    out.resize(base + count);
+    if (!decodeColumns(p, end, out.data() + base, count)) {
+        out.resize(base);
+        return 0;
+    }
+    return p - data;
+}
@@ -0,0 +1,48 @@
+#ifndef HISTORY_CODEC_H
+#define HISTORY_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// One litterbox visit as stored in a history block. Kept free of Arduino
+// types so the codec can be built and exercised on a host machine.
+struct HistorySample {
+    uint32_t timestamp;
+    int32_t weightGrams;
+    int32_t durationSeconds;
+};
+
+namespace HistoryCodec {
+
+    /**
+     * @brief Encode one pet's samples as a columnar block and append it to out.
+     *
+     * Layout (all varints, LEB128):
+     *   count
+     *   timestamps: first value, first delta, then zigzag delta-of-delta
+     *   weights:    zigzag first value, then zigzag deltas
+     *   durations:  plain values
+     *
+     * Samples must be sorted by timestamp. Visits are irregular but clustered,
+     * so delta-of-delta keeps most timestamps to 2-3 bytes, and weight deltas
+     * between consecutive visits of one pet are usually a single byte.
+     * @return Number of bytes appended.
+     */
+    size_t encodeBlock(const HistorySample *samples, size_t count, std::vector<uint8_t> &out);
+
+    /**
+     * @brief Decode a block produced by encodeBlock, appending samples to out.
+     * @return Number of bytes consumed, or 0 if the block is truncated or malformed.
+     */
+    size_t decodeBlock(const uint8_t *data, size_t length, std::vector<HistorySample> &out);
+
+    // Worst-case encoded size for a block of count samples
+    size_t maxBlockSize(size_t count);
+
+    inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+}
+
+#endif
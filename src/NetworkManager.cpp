@@ -9,7 +9,7 @@ NetworkManager::NetworkManager(Preferences &prefs) : _prefs(prefs)
     memset(_time_zone, 0, sizeof(_time_zone));
 }
 
-void NetworkManager::connectOrProvision(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *display)
+bool NetworkManager::connectOrProvision(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *display)
 {
     WiFiProvisioner provisioner(provisionerCustom);
 
@@ -36,7 +36,7 @@ void NetworkManager::connectOrProvision(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS
     {
         Serial.println("No saved WiFi. Starting provisioning.");
         provisioner.startProvisioning();
-        return;
+        return false;
     }
 
     WiFi.begin(ssid.c_str(), pass.c_str());
@@ -60,8 +60,10 @@ void NetworkManager::connectOrProvision(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS
             display->display();
         }
         provisioner.startProvisioning();
+        return display != nullptr;
     }
     Serial.println("\nWiFi Connected!");
+    return false;
 }
 
 bool NetworkManager::syncTime(RTC_PCF8563 &rtc)
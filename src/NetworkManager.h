@@ -19,8 +19,9 @@ class NetworkManager {
 public:
     NetworkManager(Preferences& prefs);
     
-    // Connect to WiFi, falling back to provisioning if it fails
-    void connectOrProvision(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *display);
+    // Connect to WiFi, falling back to provisioning if it fails.
+    // Returns true if the provisioning notice replaced what was on the panel.
+    bool connectOrProvision(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *display);
 
     //load time from rtc, and set timezone from NVS
     bool initializeFromRtc(RTC_PCF8563& rtc);
@@ -0,0 +1,191 @@
+#include "PetHistory.h"
+#include <algorithm>
+
+void PetSeries::reserve(size_t n) {
+    _timestamps.reserve(n);
+    _weights.reserve(n);
+    _durations.reserve(n);
+}
+
+void PetSeries::clear() {
+    _timestamps.clear();
+    _weights.clear();
+    _durations.clear();
+}
+
+LitterboxRecord PetSeries::record(size_t i) const {
+    LitterboxRecord rec;
+    rec.timestamp = _timestamps[i];
+    rec.weight_grams = _weights[i];
+    rec.duration_seconds = _durations[i];
+    rec.pet_id = _petId;
+    return rec;
+}
+
+size_t PetSeries::lowerBound(time_t ts) const {
+    return std::lower_bound(_timestamps.begin(), _timestamps.end(), ts) - _timestamps.begin();
+}
+
+bool PetSeries::insert(time_t ts, int32_t weight, int32_t duration) {
+    if (empty() || ts > _timestamps.back()) {
+        _timestamps.push_back(ts);
+        _weights.push_back(weight);
+        _durations.push_back(duration);
+        return true;
+    }
+
+    size_t i = lowerBound(ts);
+    if (i < size() && _timestamps[i] == ts) {
+        if (_weights[i] == weight && _durations[i] == duration) return false;
+        _weights[i] = weight;
+        _durations[i] = duration;
+        return true;
+    }
+    _timestamps.insert(_timestamps.begin() + i, ts);
+    _weights.insert(_weights.begin() + i, weight);
+    _durations.insert(_durations.begin() + i, duration);
+    return true;
+}
+
+size_t PetSeries::merge(const LitterboxRecord *records, size_t count, std::vector<LitterboxRecord> *changed) {
+    if (count == 0) return 0;
+
+    size_t added = 0;
+    auto note = [&](const LitterboxRecord &rec) {
+        added++;
+        if (changed) {
+            changed->push_back(rec);
+            changed->back().pet_id = _petId;
+        }
+    };
+
+    // A timestamp repeated within the batch keeps its last record. Each run
+    // is collapsed to that one before it is compared or noted, so the series
+    // and the changed list agree and a record is noted once.
+    auto runEnd = [&](size_t j) {
+        while (j + 1 < count && records[j + 1].timestamp == records[j].timestamp) j++;
+        return j;
+    };
+
+    // Step over the overlap with records already held. A fetch mostly repeats
+    // what is stored, and identical records are neither copied nor rewritten.
+    size_t i = lowerBound(records[0].timestamp);
+    size_t j = 0;
+    while (j < count && i < size()) {
+        size_t k = runEnd(j);
+        if (_timestamps[i] < records[k].timestamp) {
+            i++;
+        } else if (_timestamps[i] == records[k].timestamp && _weights[i] == records[k].weight_grams &&
+                   _durations[i] == records[k].duration_seconds) {
+            j = k + 1;
+        } else {
+            break;
+        }
+    }
+    if (j == count) return 0;
+    records += j;
+    count -= j;
+
+    // Everything newer than what we hold: straight append
+    if (empty() || records[0].timestamp > _timestamps.back()) {
+        reserve(size() + count);
+        for (size_t j = 0; j < count; j = runEnd(j) + 1) {
+            const LitterboxRecord &rec = records[runEnd(j)];
+            if (insert(rec.timestamp, rec.weight_grams, rec.duration_seconds)) note(rec);
+        }
+        return added;
+    }
+
+    // Rebuild the tail from the first incoming timestamp onwards in one ordered pass
+    size_t start = lowerBound(records[0].timestamp);
+    size_t tail = size() - start;
+    PsramVector<time_t> ts;
+    PsramVector<int32_t> w, d;
+    ts.reserve(tail + count);
+    w.reserve(tail + count);
+    d.reserve(tail + count);
+
+    i = start;
+    j = 0;
+    while (i < size() || j < count) {
+        if (j == count || (i < size() && _timestamps[i] < records[j].timestamp)) {
+            ts.push_back(_timestamps[i]);
+            w.push_back(_weights[i]);
+            d.push_back(_durations[i]);
+            i++;
+            continue;
+        }
+        size_t k = runEnd(j);
+        const LitterboxRecord &rec = records[k];
+        if (i < size() && _timestamps[i] == rec.timestamp) {
+            bool same = _weights[i] == rec.weight_grams && _durations[i] == rec.duration_seconds;
+            ts.push_back(_timestamps[i]);
+            w.push_back(rec.weight_grams);
+            d.push_back(rec.duration_seconds);
+            if (!same) note(rec);
+            i++;
+        } else {
+            ts.push_back(rec.timestamp);
+            w.push_back(rec.weight_grams);
+            d.push_back(rec.duration_seconds);
+            note(rec);
+        }
+        j = k + 1;
+    }
+
+    if (added == 0) return 0;
+    _timestamps.resize(start);
+    _weights.resize(start);
+    _durations.resize(start);
+    _timestamps.insert(_timestamps.end(), ts.begin(), ts.end());
+    _weights.insert(_weights.end(), w.begin(), w.end());
+    _durations.insert(_durations.end(), d.begin(), d.end());
+    return added;
+}
+
+PetSeries &PetDataMap::operator[](int petId) {
+    auto it = std::lower_bound(_pets.begin(), _pets.end(), petId,
+                               [](const PetSeries &s, int id) { return s.petId() < id; });
+    if (it == _pets.end() || it->petId() != petId) {
+        it = _pets.insert(it, PetSeries(petId));
+    }
+    return *it;
+}
+
+PetSeries *PetDataMap::find(int petId) {
+    for (auto &series : _pets) {
+        if (series.petId() == petId) return &series;
+    }
+    return nullptr;
+}
+
+const PetSeries *PetDataMap::find(int petId) const {
+    for (const auto &series : _pets) {
+        if (series.petId() == petId) return &series;
+    }
+    return nullptr;
+}
+
+// The bucket seconds fall in, the last one taking everything past it
+static void countInBucket(uint16_t *counts, uint32_t seconds, uint32_t bucketSeconds) {
+    counts[std::min<uint32_t>(seconds / bucketSeconds, ROLLUP_BUCKETS - 1)]++;
+}
+
+void addVisit(DailyRollup &rollup, int32_t weight, uint32_t duration, int64_t interval) {
+    rollup.visits++;
+    rollup.minWeight = std::min(rollup.minWeight, weight);
+    rollup.maxWeight = std::max(rollup.maxWeight, weight);
+    rollup.sumWeight += weight;
+    rollup.sumDuration += duration;
+    rollup.maxDuration = std::max(rollup.maxDuration, duration);
+    if (interval >= 0) {
+        rollup.intervals++;
+        rollup.sumInterval += interval;
+        rollup.maxInterval = std::max<uint32_t>(rollup.maxInterval, interval);
+    }
+}
+
+void addVisit(BucketCounts &counts, uint32_t duration, int64_t interval) {
+    countInBucket(counts.duration, duration, DURATION_BUCKET_SECONDS);
+    if (interval >= 0) countInBucket(counts.interval, interval, INTERVAL_BUCKET_SECONDS);
+}
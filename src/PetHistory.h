@@ -0,0 +1,149 @@
+#ifndef PET_HISTORY_H
+#define PET_HISTORY_H
+
+#include <Arduino.h>
+#include <vector>
+#include <map>
+#include <esp_heap_caps.h>
+#include "PetKitApi.h"
+
+// STL allocator that places container storage in PSRAM, falling back to the
+// internal heap on boards without it. Keeps a year of history from
+// fragmenting the small internal heap.
+template <typename T>
+struct PsramAllocator {
+    typedef T value_type;
+
+    PsramAllocator() = default;
+    template <typename U>
+    PsramAllocator(const PsramAllocator<U> &) {}
+
+    T *allocate(size_t n) {
+        void *p = heap_caps_malloc(n * sizeof(T), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!p) p = heap_caps_malloc(n * sizeof(T), MALLOC_CAP_8BIT);
+        if (!p) abort();
+        return static_cast<T *>(p);
+    }
+
+    void deallocate(T *p, size_t) { heap_caps_free(p); }
+};
+
+template <typename T, typename U>
+bool operator==(const PsramAllocator<T> &, const PsramAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator!=(const PsramAllocator<T> &, const PsramAllocator<U> &) { return false; }
+
+template <typename T>
+using PsramVector = std::vector<T, PsramAllocator<T>>;
+
+// All records of one pet, sorted by timestamp and stored as parallel
+// columns so range scans touch only the fields they use.
+class PetSeries {
+public:
+    explicit PetSeries(int petId) : _petId(petId) {}
+
+    int petId() const { return _petId; }
+    size_t size() const { return _timestamps.size(); }
+    bool empty() const { return _timestamps.empty(); }
+    void reserve(size_t n);
+    void clear();
+
+    time_t timestamp(size_t i) const { return _timestamps[i]; }
+    int32_t weight(size_t i) const { return _weights[i]; }
+    int32_t duration(size_t i) const { return _durations[i]; }
+    LitterboxRecord record(size_t i) const;
+
+    // Newest timestamp held, or 0 if empty
+    time_t latest() const { return _timestamps.empty() ? 0 : _timestamps.back(); }
+
+    // Index of the first record at or after ts (binary search)
+    size_t lowerBound(time_t ts) const;
+
+    // Add or replace the record at ts. Returns false if an identical record was already held.
+    bool insert(time_t ts, int32_t weight, int32_t duration);
+
+    /**
+     * @brief Merge records sorted by timestamp into the series.
+     * Existing records past the first incoming timestamp are rebuilt in one
+     * ordered pass, so the usual case of new visits after the latest one is a
+     * plain append.
+     * @param changed If given, receives each record that was added or replaced.
+     * @return Number of records added or replaced.
+     */
+    size_t merge(const LitterboxRecord *records, size_t count, std::vector<LitterboxRecord> *changed = nullptr);
+
+private:
+    int _petId;
+    PsramVector<time_t> _timestamps;
+    PsramVector<int32_t> _weights;
+    PsramVector<int32_t> _durations;
+};
+
+// Aggregate of one pet's visits over one UTC day, used by the long-range
+// views in place of the raw records. Stored on the card as-is.
+struct __attribute__((packed)) DailyRollup {
+    uint32_t day;          // days since 1970-01-01 UTC
+    uint16_t visits;
+    uint16_t intervals;    // visits whose previous visit is on record
+    int32_t minWeight;
+    int32_t maxWeight;
+    int32_t sumWeight;
+    uint32_t sumDuration;  // seconds
+    uint32_t sumInterval;  // seconds since each visit's previous one
+    uint32_t maxDuration;
+    uint32_t maxInterval;
+};
+
+// Durations and intervals counted in fixed-width buckets from zero, the
+// last taking everything past it, so the histograms of a long range can be
+// summed from the days instead of from every visit. Kept apart from the
+// rollups, as running totals (see DataManager).
+static const int ROLLUP_BUCKETS = 32;
+static const uint32_t DURATION_BUCKET_SECONDS = 30;   // up to 16 minutes
+static const uint32_t INTERVAL_BUCKET_SECONDS = 2700; // up to 24 hours
+
+struct BucketCounts {
+    uint16_t duration[ROLLUP_BUCKETS];
+    uint16_t interval[ROLLUP_BUCKETS];
+};
+
+// Count one visit into its day. interval is the time since the pet's
+// previous visit, negative if that one is not on record.
+void addVisit(DailyRollup &rollup, int32_t weight, uint32_t duration, int64_t interval);
+void addVisit(BucketCounts &counts, uint32_t duration, int64_t interval);
+
+// One pet's non-empty days, oldest first, and the buckets of the same days summed
+struct PetRollups {
+    PsramVector<DailyRollup> days;
+    BucketCounts buckets = {};
+};
+
+// PetID -> that pet's rollups
+typedef std::map<int, PetRollups> PetRollupMap;
+
+// PetID -> PetSeries. A handful of pets, so a small vector sorted by id.
+class PetDataMap {
+public:
+    typedef std::vector<PetSeries>::iterator iterator;
+    typedef std::vector<PetSeries>::const_iterator const_iterator;
+
+    // Series for petId, created empty if not present
+    PetSeries &operator[](int petId);
+
+    PetSeries *find(int petId);
+    const PetSeries *find(int petId) const;
+
+    size_t size() const { return _pets.size(); }
+    bool empty() const { return _pets.empty(); }
+    void clear() { _pets.clear(); }
+
+    iterator begin() { return _pets.begin(); }
+    iterator end() { return _pets.end(); }
+    const_iterator begin() const { return _pets.begin(); }
+    const_iterator end() const { return _pets.end(); }
+
+private:
+    std::vector<PetSeries> _pets;
+};
+
+#endif
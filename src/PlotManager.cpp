@@ -1,106 +1,379 @@
 #include "PlotManager.h"
+#include "Clock.h"
+#include "Crc32.h"
+
+namespace
+{
+    // What the panel shows, kept across deep sleep; zeroed on power-on
+    struct ShownFrame
+    {
+        uint32_t plotsHash;
+        uint32_t statusHash;
+        uint32_t minute; // of the clock in the status bar
+        uint8_t partialRefreshes;
+        bool valid;
+    };
+    RTC_DATA_ATTR ShownFrame shown;
+
+    // Seconds local time is ahead of UTC at t
+    int32_t utcOffset(time_t t)
+    {
+        struct tm local, utc;
+        localtime_r(&t, &local);
+        gmtime_r(&t, &utc);
+        int days = local.tm_year != utc.tm_year ? local.tm_year - utc.tm_year : local.tm_yday - utc.tm_yday;
+        return ((days * 24 + local.tm_hour - utc.tm_hour) * 60 + local.tm_min - utc.tm_min) * 60;
+    }
+
+    // Days since 1970-01-01 in local time, the day the plots' axes end on
+    uint32_t localDay(time_t t)
+    {
+        return (uint32_t)((t + utcOffset(t)) / 86400);
+    }
+
+    // Smallest and largest value added so far
+    struct Extent
+    {
+        float min = HUGE_VALF;
+        float max = -HUGE_VALF;
+
+        void add(float value)
+        {
+            min = std::min(min, value);
+            max = std::max(max, value);
+        }
+    };
+
+    // One pet's stretch of each buffer drawPlots fills, and the extent of
+    // the values in it
+    struct PetColumns
+    {
+        size_t scatterStart = 0, intervalStart = 0, durationStart = 0;
+        int32_t xMin = INT32_MAX, xMax = INT32_MIN;
+        Extent weight, interval, duration;
+        // Daily ranges: the duration and interval buckets of the window
+        uint32_t durationBuckets[ROLLUP_BUCKETS] = {};
+        uint32_t intervalBuckets[ROLLUP_BUCKETS] = {};
+
+        void add(const DataPoint &point)
+        {
+            xMin = std::min(xMin, point.x);
+            xMax = std::max(xMax, point.x);
+            weight.add(point.y);
+        }
+    };
+}
+
+#if (EPD_SELECT == 1001)
+RTC_DATA_ATTR uint8_t PlotManager::_shownBar[STATUS_W / 8 * STATUS_H];
+#endif
 
 PlotManager::PlotManager(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *disp)
-    : _display(disp) {}
+    : _display(disp), _canvas(EPD_WIDTH, EPD_HEIGHT, FRAME_PAGE_ROWS),
+      _plots(EPD_WIDTH, EPD_HEIGHT, FRAME_PAGE_ROWS), _status(EPD_WIDTH, EPD_HEIGHT, FRAME_PAGE_ROWS) {}
 
-void PlotManager::renderDashboard(const std::vector<Pet> &pets, PetDataMap &allPetData, const DateRangeInfo &range, const StatusRecord &status, bool wifiSuccess, float temp, float humidity)
+void PlotManager::setFrameCache(fs::FS *fs, uint32_t dataVersion, const std::vector<Pet> &pets)
 {
-    _display->fillScreen(GxEPD_WHITE);
+    _cacheFs = fs;
+    _dataVersion = dataVersion;
+    // Renamed or reordered pets change the legends and colors
+    _petsHash = 0;
+    for (const Pet &pet : pets)
+    {
+        _petsHash = crc32(&pet.id, sizeof(pet.id), _petsHash);
+        _petsHash = crc32(pet.name.c_str(), pet.name.length() + 1, _petsHash);
+    }
+}
 
-    // Prepare vectors
-    size_t numPets = pets.size();
-    std::vector<DataPoint> pet_scatterplot[numPets];
-    std::vector<float> interval_hist[numPets];
-    std::vector<float> duration_hist[numPets];
+void PlotManager::renderDashboard(const std::vector<Pet> &pets, const PetDataMap &allPetData, const PetRollupMap &rollups, const DateRangeInfo &range, const StatusRecord &status, bool wifiSuccess, float temp, float humidity)
+{
+    drawPlots(pets, allPetData, rollups, range);
+    drawStatusBar(status);
+
+    // Cached without the status bar, which is redrawn on every wake
+    File cache = createFrame(range);
+    bool caching = (bool)cache;
+    sendFrame(nullptr, &cache);
+    if (cache)
+    {
+        cache.close();
+    }
+    else if (caching)
+    {
+        Serial.println("[PlotManager] Frame cache write failed!");
+        _cacheFs->remove(framePath(range));
+    }
+    setShown(range, status);
+}
+
+bool PlotManager::showCachedFrame(const DateRangeInfo &range, const StatusRecord &status)
+{
+    File frame = openFrame(range);
+    if (!frame)
+        return false;
+    drawStatusBar(status);
+    bool sent = sendFrame(&frame, nullptr);
+    frame.close();
+    if (!sent)
+        return false;
+    setShown(range, status);
+    return true;
+}
 
-    time_t now = time(NULL);
+PlotManager::StatusRefresh PlotManager::refreshStatus(const DateRangeInfo &range, const StatusRecord &status)
+{
+    if (!shown.valid || shown.plotsHash != plotsHash(range))
+    {
+        Serial.printf("[PlotManager] Panel does not show %s.\r\n", range.name);
+        return STATUS_NEEDS_FRAME;
+    }
+    uint32_t newStatusHash = statusHash(status);
+    bool statusChanged = shown.statusHash != newStatusHash;
+    bool clockChanged = shown.minute != (uint32_t)(Clock::now() / 60);
+    if (!statusChanged && !clockChanged)
+        return STATUS_UNCHANGED;
+
+    if (!_display->epd2.hasFastPartialUpdate)
+    {
+        bool clockStale = Clock::now() / 60 - (time_t)shown.minute >= STATUS_CLOCK_MAX_MINUTES;
+        return statusChanged || clockStale ? STATUS_NEEDS_FRAME : STATUS_UNCHANGED;
+    }
+    if (shown.partialRefreshes >= PARTIAL_REFRESH_LIMIT)
+    {
+        Serial.println("[PlotManager] Partial refresh limit reached.");
+        return STATUS_NEEDS_FRAME;
+    }
+    // Hibernate lost the controller's RAM, so first rebuild the image the
+    // partial refresh diffs against: the cached plots under the bar last sent
+    File frame = openFrame(range);
+    if (!frame)
+        return STATUS_NEEDS_FRAME;
+    bool loaded = writePrevious(&frame);
+    frame.close();
+    if (!loaded)
+        return STATUS_NEEDS_FRAME;
+    // The cached frame has no status bar, so the old one drops out of the window
+    drawStatusBar(status);
+    _status.replay(_canvas, 0);
+    if (_profiler)
+        _profiler->mark(WakeProfiler::RENDER);
+    pushStatusWindow();
+    shown.statusHash = newStatusHash;
+    shown.minute = Clock::now() / 60;
+    shown.partialRefreshes++;
+    if (_profiler)
+        _profiler->mark(WakeProfiler::REFRESH);
+    return STATUS_PARTIAL;
+}
+
+void PlotManager::forgetShownFrame()
+{
+    shown.valid = false;
+}
+
+void PlotManager::setShown(const DateRangeInfo &range, const StatusRecord &status)
+{
+    shown.plotsHash = plotsHash(range);
+    shown.statusHash = statusHash(status);
+    shown.minute = Clock::now() / 60;
+    shown.partialRefreshes = 0;
+    shown.valid = true;
+}
+
+uint32_t PlotManager::plotsHash(const DateRangeInfo &range)
+{
+    time_t now = Clock::now();
+    PlotsKey key = {EPD_SELECT, _dataVersion, _petsHash, utcOffset(now), localDay(now), (int32_t)range.type};
+    return crc32(&key, sizeof(key));
+}
+
+uint32_t PlotManager::statusHash(const StatusRecord &status)
+{
+    StatusKey key = {status.litter_percent, status.box_full, status.device_name.length() > 0,
+                     (uint16_t)lroundf(batteryVoltage() * 10)};
+    return crc32(&key, sizeof(key));
+}
+
+float PlotManager::batteryVoltage()
+{
+    int mv = analogReadMilliVolts(BATTERY_ADC_PIN);
+    float battery_voltage = (mv / 1000.0) * 2;
+    if (battery_voltage >= 4.2)
+    {
+        battery_voltage = 4.2;
+    }
+    return battery_voltage;
+}
+
+void PlotManager::drawPlots(const std::vector<Pet> &pets, const PetDataMap &allPetData, const PetRollupMap &rollups, const DateRangeInfo &range)
+{
+    _plots.clear();
+
+    size_t numPets = pets.size();
+    time_t now = Clock::now();
     time_t timeStart = now - range.seconds;
 
-    int idx = 0;
+    // Every pet's values back to back, one buffer per widget input. They are
+    // sized up front so nothing moves, and the widgets get spans into them.
+    // Those, and whatever the widgets need while drawing, come from _arena.
+    size_t capacity = 0;
     for (const auto &pet : pets)
     {
-        if (allPetData.find(pet.id) == allPetData.end())
+        if (range.daily)
         {
-            idx++;
-            continue;
+            auto it = rollups.find(pet.id);
+            if (it != rollups.end())
+                capacity += it->second.days.size();
         }
+        else if (const PetSeries *series = allPetData.find(pet.id))
+            capacity += series->size() - series->lowerBound(timeStart);
+    }
+    // Daily ranges take the histograms from the rollups' buckets instead
+    size_t values = range.daily ? 0 : capacity;
+    _arena.reset(capacity * sizeof(DataPoint) + values * 2 * sizeof(float) + ScatterPlot::scratchBytes(capacity, EPD_WIDTH, EPD_HEIGHT * 3 / 4) + ARENA_SLACK);
+    ArenaVector<DataPoint> scatter(&_arena);
+    ArenaVector<float> intervals(&_arena), durations(&_arena);
+    scatter.reserve(capacity);
+    intervals.reserve(values);
+    durations.reserve(values);
+    // Where each pet's values start, then where the last pet's end
+    ArenaVector<PetColumns> columns(numPets + 1, PetColumns(), &_arena);
 
-        time_t lastTimestamp = -1;
-        for (auto const &recordPair : allPetData[pet.id])
+    // One pass per pet from the start of the range, the extent of each
+    // column kept as it goes, so the widgets do not have to look for it
+    int idx = 0;
+    for (const auto &pet : pets)
+    {
+        PetColumns &col = columns[idx++];
+        col.scatterStart = scatter.size();
+        col.intervalStart = intervals.size();
+        col.durationStart = durations.size();
+        if (range.daily)
         {
-            const LitterboxRecord &record = recordPair.second;
-            if (record.timestamp < timeStart)
+            // Long ranges plot one point per day: the day's mean weight at noon UTC.
+            // The histograms still count every visit, from the days' buckets.
+            auto it = rollups.find(pet.id);
+            if (it == rollups.end())
                 continue;
+            for (int b = 0; b < ROLLUP_BUCKETS; b++)
+            {
+                col.durationBuckets[b] = it->second.buckets.duration[b];
+                col.intervalBuckets[b] = it->second.buckets.interval[b];
+            }
+            uint32_t startDay = timeStart / 86400;
+            for (const DailyRollup &day : it->second.days)
+            {
+                if (day.day < startDay || day.visits == 0)
+                    continue;
+                time_t noon = (time_t)day.day * 86400L + 43200;
+                float weight_lbs = (float)day.sumWeight / day.visits / GRAMS_PER_POUND;
+                DataPoint point = {(int32_t)(noon - timeStart), weight_lbs};
+                scatter.push_back(point);
+                col.add(point);
+                col.duration.add(day.maxDuration / 60.0f);
+                if (day.intervals > 0)
+                    col.interval.add(day.maxInterval / 3600.0f);
+            }
+            continue;
+        }
 
-            float weight_lbs = (float)record.weight_grams / GRAMS_PER_POUND;
-            struct tm* thistimestamp = localtime(&record.timestamp);
-            time_t ts = mktime(thistimestamp);
-            pet_scatterplot[idx].push_back({(float)ts, weight_lbs});
-            duration_hist[idx].push_back((float)record.duration_seconds / 60.0);
-
-            if (lastTimestamp > 0)
-                interval_hist[idx].push_back(((float)(record.timestamp - lastTimestamp)) / 3600.0);
+        const PetSeries *series = allPetData.find(pet.id);
+        if (series == nullptr)
+            continue;
 
-            lastTimestamp = record.timestamp;
+        size_t first = series->lowerBound(timeStart);
+        for (size_t i = first; i < series->size(); i++)
+        {
+            time_t timestamp = series->timestamp(i);
+            float weight_lbs = (float)series->weight(i) / GRAMS_PER_POUND;
+            DataPoint point = {(int32_t)(timestamp - timeStart), weight_lbs};
+            scatter.push_back(point);
+            col.add(point);
+            float duration = (float)series->duration(i) / 60.0;
+            durations.push_back(duration);
+            col.duration.add(duration);
+            if (i > first)
+            {
+                float interval = ((float)(timestamp - series->timestamp(i - 1))) / 3600.0;
+                intervals.push_back(interval);
+                col.interval.add(interval);
+            }
         }
-        idx++;
     }
+    columns[numPets].scatterStart = scatter.size();
+    columns[numPets].intervalStart = intervals.size();
+    columns[numPets].durationStart = durations.size();
 
     // --- Draw Histograms ---
-    Histogram histInterval(_display, 0, _display->height() * 3 / 4, _display->width() / 2, _display->height() / 4);
+    Histogram histInterval(&_plots, 0, _plots.height() * 3 / 4, _plots.width() / 2, _plots.height() / 4, &_arena);
     histInterval.setTitle("Interval (Hours)");
     histInterval.setBinCount(16);
     histInterval.setNormalization(true);
 
-    Histogram histDuration(_display, _display->width() / 2, _display->height() * 3 / 4, _display->width() / 2, _display->height() / 4);
+    Histogram histDuration(&_plots, _plots.width() / 2, _plots.height() * 3 / 4, _plots.width() / 2, _plots.height() / 4, &_arena);
     histDuration.setTitle("Duration (Minutes)");
     histDuration.setBinCount(16);
     histDuration.setNormalization(true);
 
     for (int i = 0; i < numPets; ++i)
     {
-        histInterval.addSeries(pets[i].name.c_str(), interval_hist[i], _petColors[i % 4].color, _petColors[i % 4].background);
-        histDuration.addSeries(pets[i].name.c_str(), duration_hist[i], _petColors[i % 4].color, _petColors[i % 4].background);
+        const PetColumns &col = columns[i], &next = columns[i + 1];
+        if (range.daily)
+        {
+            histInterval.addBucketedSeries(pets[i].name.c_str(), Span<uint32_t>(col.intervalBuckets, ROLLUP_BUCKETS), INTERVAL_BUCKET_SECONDS / 3600.0f, col.interval.max, _petColors[i % 4].color, _petColors[i % 4].background);
+            histDuration.addBucketedSeries(pets[i].name.c_str(), Span<uint32_t>(col.durationBuckets, ROLLUP_BUCKETS), DURATION_BUCKET_SECONDS / 60.0f, col.duration.max, _petColors[i % 4].color, _petColors[i % 4].background);
+            continue;
+        }
+        histInterval.addSeries(pets[i].name.c_str(), Span<float>(intervals.data() + col.intervalStart, next.intervalStart - col.intervalStart), col.interval.min, col.interval.max, _petColors[i % 4].color, _petColors[i % 4].background);
+        histDuration.addSeries(pets[i].name.c_str(), Span<float>(durations.data() + col.durationStart, next.durationStart - col.durationStart), col.duration.min, col.duration.max, _petColors[i % 4].color, _petColors[i % 4].background);
     }
 
     histInterval.plot();
     histDuration.plot();
 
     // --- Draw ScatterPlot ---
-    ScatterPlot plot(_display, 0, 0, EPD_WIDTH, EPD_HEIGHT * 3 / 4);
+    ScatterPlot plot(&_plots, 0, 0, EPD_WIDTH, EPD_HEIGHT * 3 / 4, &_arena);
     char title[64];
     sprintf(title, "Weight (lb) - %s", range.name);
     plot.setLabels(title, "Date", "Weight(lb)");
+    plot.setTimeOrigin(timeStart);
 
     int xticks = (range.type == LAST_7_DAYS) ? 10 : 18; // Simplified logic
 
     for (int i = 0; i < numPets; ++i)
     {
-        plot.addSeries(pets[i].name.c_str(), pet_scatterplot[i], _petColors[i % 4].color, _petColors[i % 4].background, xticks, 10);
+        const PetColumns &col = columns[i], &next = columns[i + 1];
+        plot.addSeries(pets[i].name.c_str(), Span<DataPoint>(scatter.data() + col.scatterStart, next.scatterStart - col.scatterStart), col.xMin, col.xMax, col.weight.min, col.weight.max, _petColors[i % 4].color, _petColors[i % 4].background, xticks, 10);
     }
     plot.draw();
 
-    // --- Status Bar ---
-    int mv = analogReadMilliVolts(BATTERY_ADC_PIN);
-    float battery_voltage = (mv / 1000.0) * 2;
+    if (_profiler)
+        _profiler->setRenderArenaBytes(_arena.highWater());
+}
+
+void PlotManager::drawStatusBar(const StatusRecord &status)
+{
+    _status.clear();
+    // Measure with the font the bar is printed in, whatever was drawn before
+    _status.setFont(NULL);
+    _status.setTextSize(1);
+
+    time_t now;
+    float battery_voltage = batteryVoltage();
     int16_t x = 0, y = 0, x1 = 0, y1 = 0;
     uint16_t w = 0, h = 0;
-    if (battery_voltage >= 4.2)
-    {
-        battery_voltage = 4.2;
-    }
     char buffer[32];
 
     // Draw Battery
     sprintf(buffer, "Battery: %.2fV", battery_voltage);
-    _display->getTextBounds(buffer, x, y, &x1, &y1, &w, &h);
+    _status.getTextBounds(buffer, x, y, &x1, &y1, &w, &h);
     x = EPD_WIDTH - w - 15;
     y = h * 3 / 2 + 4;
-    _display->setFont(NULL); // Use the provided font
-    _display->setTextSize(1);
-    _display->setTextColor(EPD_BLACK); // Use the provided color
-    _display->setCursor(x, y);
-    _display->print(buffer);
+    _status.setFont(NULL); // Use the provided font
+    _status.setTextSize(1);
+    _status.setTextColor(EPD_BLACK); // Use the provided color
+    _status.setCursor(x, y);
+    _status.print(buffer);
 
     // Draw Update Time
     struct tm timeinfo;
@@ -113,42 +386,225 @@ void PlotManager::renderDashboard(const std::vector<Pet> &pets, PetDataMap &allP
     w = 0;
     h = 0;
 
-    time(&now);                   // Get current epoch time
+    now = Clock::now();           // Get current epoch time
     localtime_r(&now, &timeinfo); // Convert to struct tm
     strftime(strftime_buf, sizeof(strftime_buf), "%m/%d/%y %H:%M", &timeinfo);
-    _display->setFont(NULL);
-    _display->setTextSize(1);
-    _display->getTextBounds(strftime_buf, x, y, &x1, &y1, &w, &h);
+    _status.setFont(NULL);
+    _status.setTextSize(1);
+    _status.getTextBounds(strftime_buf, x, y, &x1, &y1, &w, &h);
     x = EPD_WIDTH - 15 - w;
-    _display->setFont(NULL); // Use the provided font
-    _display->setTextSize(1);
-    _display->setTextColor(EPD_BLACK); // Use the provided color
-    _display->setCursor(x, h / 2);
-    _display->print(strftime_buf);
+    _status.setFont(NULL); // Use the provided font
+    _status.setTextSize(1);
+    _status.setTextColor(EPD_BLACK); // Use the provided color
+    _status.setCursor(x, h / 2);
+    _status.print(strftime_buf);
 
     if (status.device_name.length() > 0)
     {
-        _display->setFont(NULL);
-        _display->setTextSize(0);
-        _display->setTextColor(EPD_BLACK);
+        _status.setFont(NULL);
+        _status.setTextSize(0);
+        _status.setTextColor(EPD_BLACK);
 
         char buffer[32];
         int16_t x = EPD_WIDTH * 3 / 4, y = 2, x1, y1;
         uint16_t w, h;
         sprintf(buffer, "Litter: %d%%", status.litter_percent);
-        _display->getTextBounds(buffer, x, y, &x1, &y1, &w, &h);
+        _status.getTextBounds(buffer, x, y, &x1, &y1, &w, &h);
         x = EPD_WIDTH - 20 - w - 120;
-        _display->setCursor(x, h / 2);
-        _display->print(buffer);
+        _status.setCursor(x, h / 2);
+        _status.print(buffer);
 
-        _display->setCursor(x, 3 * h / 2 + 4);
+        _status.setCursor(x, 3 * h / 2 + 4);
         if (status.box_full)
         {
-            _display->print("FULL");
+            _status.print("FULL");
         }
         else
         {
-            _display->print("Box OK");
+            _status.print("Box OK");
+        }
+    }
+}
+
+bool PlotManager::drawPage(int16_t page, File *from)
+{
+    // The plots for one page: replayed, or read from a cache file from openFrame
+    _canvas.setBand(page * FRAME_PAGE_ROWS);
+    if (from == nullptr)
+    {
+        _canvas.fillScreen(GxEPD_WHITE);
+        _plots.replay(_canvas, page);
+        return true;
+    }
+    return from->seek(sizeof(FrameHeader) + (size_t)_canvas.bandTop() * _canvas.rowBytes()) &&
+           from->read(_canvas.buffer(), _canvas.bufferSize()) == _canvas.bufferSize();
+}
+
+bool PlotManager::sendFrame(File *from, File *to)
+{
+    // Page by page with the status bar on top; each page of plots also goes
+    // to the cache file to, which is closed and cleared if a write fails
+    for (int16_t page = 0; page < PAGE_COUNT; page++)
+    {
+        if (!drawPage(page, from))
+            return false;
+        if (to && *to && to->write(_canvas.buffer(), _canvas.bufferSize()) != _canvas.bufferSize())
+        {
+            to->close();
+            *to = File();
+        }
+        _status.replay(_canvas, page);
+        if (_profiler)
+            _profiler->mark(WakeProfiler::RENDER);
+        writePage(page, false);
+        if (_profiler)
+            _profiler->mark(WakeProfiler::REFRESH);
+    }
+    _display->epd2.refresh(false);
+
+#if (EPD_SELECT == 1001)
+    // Partial updates diff against the controller's copy of the previous frame
+    if (_display->epd2.hasFastPartialUpdate)
+    {
+        for (int16_t page = 0; page < PAGE_COUNT; page++)
+        {
+            if (PAGE_COUNT > 1)
+            {
+                if (!drawPage(page, from))
+                    break;
+                _status.replay(_canvas, page);
+            }
+            if (page == 0)
+                saveStatusWindow(_shownBar);
+            writePage(page, true);
         }
     }
-}
\ No newline at end of file
+#endif
+    if (_profiler)
+        _profiler->mark(WakeProfiler::REFRESH);
+    return true;
+}
+
+void PlotManager::writePage(int16_t page, bool again)
+{
+    // Same calls GxEPD2's display() makes for a buffer of these rows
+    int16_t top = page * FRAME_PAGE_ROWS;
+#if (EPD_SELECT == 1002)
+    _display->epd2.writeNative(_canvas.buffer(), 0, 0, top, EPD_WIDTH, _canvas.bandRows(), false, false, false);
+#else
+    if (again)
+        _display->epd2.writeImageAgain(_canvas.buffer(), 0, top, EPD_WIDTH, _canvas.bandRows());
+    else
+        _display->epd2.writeImageForFullRefresh(_canvas.buffer(), 0, top, EPD_WIDTH, _canvas.bandRows());
+#endif
+}
+
+bool PlotManager::writePrevious(File *from)
+{
+#if (EPD_SELECT == 1001)
+    // Last page first, so the first one is left loaded for the new status bar
+    for (int16_t page = PAGE_COUNT - 1; page >= 0; page--)
+    {
+        if (!drawPage(page, from))
+            return false;
+        if (page == 0)
+            swapStatusWindow(_shownBar);
+        _display->epd2.writeImagePrevious(_canvas.buffer(), 0, _canvas.bandTop(), EPD_WIDTH, _canvas.bandRows());
+        if (page == 0)
+            swapStatusWindow(_shownBar);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void PlotManager::pushStatusWindow()
+{
+#if (EPD_SELECT == 1001)
+    // GxEPD2's displayWindow() sequence, from the first page
+    _display->epd2.writeImagePart(_canvas.buffer(), STATUS_X, STATUS_Y, EPD_WIDTH, _canvas.bandRows(), STATUS_X, STATUS_Y, STATUS_W, STATUS_H);
+    _display->epd2.refresh(STATUS_X, STATUS_Y, STATUS_W, STATUS_H);
+    _display->epd2.writeImagePartAgain(_canvas.buffer(), STATUS_X, STATUS_Y, EPD_WIDTH, _canvas.bandRows(), STATUS_X, STATUS_Y, STATUS_W, STATUS_H);
+    saveStatusWindow(_shownBar);
+#endif
+}
+
+#if (EPD_SELECT == 1001)
+void PlotManager::saveStatusWindow(uint8_t *bar)
+{
+    const uint8_t *row = _canvas.buffer() + STATUS_Y * _canvas.rowBytes() + STATUS_X / 8;
+    for (int16_t y = 0; y < STATUS_H; y++, row += _canvas.rowBytes(), bar += STATUS_W / 8)
+        memcpy(bar, row, STATUS_W / 8);
+}
+
+void PlotManager::swapStatusWindow(uint8_t *bar)
+{
+    uint8_t *row = _canvas.buffer() + STATUS_Y * _canvas.rowBytes() + STATUS_X / 8;
+    for (int16_t y = 0; y < STATUS_H; y++, row += _canvas.rowBytes(), bar += STATUS_W / 8)
+        std::swap_ranges(bar, bar + STATUS_W / 8, row);
+}
+#endif
+
+String PlotManager::framePath(const DateRangeInfo &range)
+{
+    char path[32];
+    snprintf(path, sizeof(path), "%s/frame_%d.bin", _cacheDir, (int)range.type);
+    return String(path);
+}
+
+File PlotManager::createFrame(const DateRangeInfo &range)
+{
+    if (_cacheFs == nullptr)
+        return File();
+    if (!_cacheFs->exists(_cacheDir))
+        _cacheFs->mkdir(_cacheDir);
+
+    time_t now = Clock::now();
+    FrameHeader header = {FRAME_MAGIC, EPD_SELECT, _dataVersion, _petsHash, utcOffset(now), localDay(now),
+                          (uint32_t)(EPD_HEIGHT * _canvas.rowBytes())};
+    File file = _cacheFs->open(framePath(range), FILE_WRITE);
+    if (!file)
+    {
+        Serial.println("[PlotManager] Failed to open frame cache for writing!");
+        return File();
+    }
+    // A short write leaves a file openFrame rejects on size
+    if (file.write((const uint8_t *)&header, sizeof(header)) != sizeof(header))
+    {
+        file.close();
+        Serial.println("[PlotManager] Frame cache write failed!");
+        _cacheFs->remove(framePath(range));
+        return File();
+    }
+    return file;
+}
+
+File PlotManager::openFrame(const DateRangeInfo &range)
+{
+    if (_cacheFs == nullptr)
+        return File();
+    File file = _cacheFs->open(framePath(range), FILE_READ);
+    if (!file)
+        return File();
+
+    // Valid only for the same history, pets and timezone, and the same day,
+    // since the ranges end at "now"
+    time_t now = Clock::now();
+    FrameHeader header;
+    size_t frameBytes = EPD_HEIGHT * _canvas.rowBytes();
+    bool ok = file.size() == sizeof(header) + frameBytes &&
+              file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+              header.magic == FRAME_MAGIC && header.panel == EPD_SELECT &&
+              header.dataVersion == _dataVersion && header.petsHash == _petsHash &&
+              header.utcOffset == utcOffset(now) && header.day == localDay(now) &&
+              header.frameBytes == frameBytes;
+
+    Serial.printf("[PlotManager] Cached frame for %s: %s\r\n", range.name, ok ? "hit" : "miss");
+    if (!ok)
+    {
+        file.close();
+        return File();
+    }
+    return file;
+}
@@ -1,24 +1,147 @@
 #ifndef PLOT_MANAGER_H
 #define PLOT_MANAGER_H
 
+#include <FS.h>
 #include "SharedTypes.h"
 #include "config.h"
+#include "FrameCanvas.h"
+#include "DisplayList.h"
 #include "ScatterPlot.h"
 #include "histogram.h"
+#include "RenderArena.h"
+#include "WakeProfiler.h"
 
 class PlotManager {
 public:
     PlotManager(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *display);
     
     void renderDashboard(const std::vector<Pet> &pets, 
-                         PetDataMap &allPetData, 
+                         const PetDataMap &allPetData, 
+                         const PetRollupMap &rollups,
                          const DateRangeInfo &range,
                          const StatusRecord &status,
                          bool wifiSuccess,
                          float temp,
                          float humidity);
+
+    // Keep finished frames on fs, one per date range, keyed by the history's
+    // data version, the pets drawn and the timezone. Without this call
+    // nothing is cached.
+    void setFrameCache(fs::FS *fs, uint32_t dataVersion, const std::vector<Pet> &pets);
+
+    // Send the cached frame for range to the panel with a fresh status bar.
+    // Returns false if there is none for the current data version and day.
+    bool showCachedFrame(const DateRangeInfo &range, const StatusRecord &status);
+
+    enum StatusRefresh {
+        STATUS_UNCHANGED,   // panel already up to date
+        STATUS_PARTIAL,     // status bar window sent as a partial refresh
+        STATUS_NEEDS_FRAME  // a full frame has to go out
+    };
+
+    // If the panel still shows range as sent on an earlier wake, for the same
+    // history, pets and timezone (see setFrameCache) and day, bring only its
+    // status bar up to date. The B&W panel takes a partial refresh of the
+    // bar's window, at most PARTIAL_REFRESH_LIMIT in a row, after the cached
+    // frame and the bar last sent are rewritten as the image it diffs against.
+    // The color panel needs a full frame for anything else in the bar, and
+    // for the clock once it is STATUS_CLOCK_MAX_MINUTES old.
+    StatusRefresh refreshStatus(const DateRangeInfo &range, const StatusRecord &status);
+
+    // Something else was drawn on the panel, so the next frame must go out
+    void forgetShownFrame();
+
+    // Mark RENDER and REFRESH on profiler as frames go out. Optional.
+    void setProfiler(WakeProfiler *profiler) { _profiler = profiler; }
+
+    // The page of the frame last drawn or loaded
+    const FrameCanvas &canvas() const { return _canvas; }
+
+    // Memory the recorded plots and status bar take
+    size_t displayListBytes() const { return _plots.bytes() + _status.bytes(); }
+
+    // Most of the render arena any frame so far has used
+    size_t renderArenaHighWater() const { return _arena.highWater(); }
+
 private:
     GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *_display;
+    FrameCanvas _canvas;
+    // Recorded once per frame, replayed into _canvas page by page
+    DisplayList _plots;
+    DisplayList _status;
+    // Everything drawPlots and the widgets need only while drawing
+    RenderArena _arena;
+
+    static const int16_t PAGE_COUNT = (EPD_HEIGHT + FRAME_PAGE_ROWS - 1) / FRAME_PAGE_ROWS;
+    // Arena on top of drawPlots' estimate, for the series lists and bins
+    static const size_t ARENA_SLACK = 4096;
+
+    // Frame cache file: header, then the frame as the panel takes it
+    struct __attribute__((packed)) FrameHeader {
+        uint32_t magic;
+        uint32_t panel;       // EPD_SELECT the frame was drawn for
+        uint32_t dataVersion;
+        uint32_t petsHash;    // ids and names, in the order drawn
+        int32_t utcOffset;    // seconds, of the local time the axes are in
+        uint32_t day;         // local days since 1970-01-01
+        uint32_t frameBytes;
+    };
+    static const uint32_t FRAME_MAGIC = 0x43464B50; // "PKFC"
+
+    // What a frame is drawn from, hashed per layout region and kept in RTC
+    // memory once the frame is on the panel. The battery only counts to a
+    // tenth of a volt, or ADC noise alone would force a refresh.
+    struct __attribute__((packed)) PlotsKey {
+        uint32_t panel;
+        uint32_t dataVersion;
+        uint32_t petsHash;
+        int32_t utcOffset;
+        uint32_t day;
+        int32_t range;
+    };
+    struct __attribute__((packed)) StatusKey {
+        int32_t litterPercent;
+        uint8_t boxFull;
+        uint8_t hasDevice;
+        uint16_t batteryDecivolts;
+    };
+
+    // Window around everything drawStatusBar prints, x and width on byte
+    // boundaries for the controller
+    static const int16_t STATUS_X = EPD_WIDTH - 224;
+    static const int16_t STATUS_Y = 0;
+    static const int16_t STATUS_W = 224;
+    static const int16_t STATUS_H = 24;
+    static_assert(STATUS_Y + STATUS_H <= FRAME_PAGE_ROWS, "status bar must fit the first page");
+#if (EPD_SELECT == 1001)
+    // The status bar window as the panel shows it, kept across deep sleep
+    static uint8_t _shownBar[STATUS_W / 8 * STATUS_H];
+#endif
+
+    const char *_cacheDir = "/cache";
+    fs::FS *_cacheFs = nullptr;
+    uint32_t _dataVersion = 0;
+    uint32_t _petsHash = 0;
+    WakeProfiler *_profiler = nullptr;
+
+    void drawPlots(const std::vector<Pet> &pets, const PetDataMap &allPetData, const PetRollupMap &rollups, const DateRangeInfo &range);
+    void drawStatusBar(const StatusRecord &status);
+    bool drawPage(int16_t page, File *from);
+    bool sendFrame(File *from, File *to);
+    void writePage(int16_t page, bool again);
+    bool writePrevious(File *from);
+    void pushStatusWindow();
+#if (EPD_SELECT == 1001)
+    void saveStatusWindow(uint8_t *bar);
+    void swapStatusWindow(uint8_t *bar);
+#endif
+    void setShown(const DateRangeInfo &range, const StatusRecord &status);
+    uint32_t plotsHash(const DateRangeInfo &range);
+    uint32_t statusHash(const StatusRecord &status);
+    float batteryVoltage();
+    File createFrame(const DateRangeInfo &range);
+    File openFrame(const DateRangeInfo &range);
+    String framePath(const DateRangeInfo &range);
     
     // Constants for colors, layout, etc.
     struct ColorPair {
@@ -0,0 +1,135 @@
+#include "PlotSurface.h"
+#include <algorithm>
+#include <string.h>
+
+void PlotSurface::fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2)
+{
+    for (int16_t y = 0; y < h; y++)
+    {
+        for (int16_t x = 0; x < w; x++)
+            drawPixel(x0 + x, y0 + y, (x + y) & 1 ? color1 : color2);
+    }
+}
+
+void PlotSurface::fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color)
+{
+    if (w <= 0 || h <= 0 || spacing <= 0)
+        return;
+    // Lines of the form x + y = k, clipped to the rectangle
+    for (int16_t k = spacing; k < w + h; k += spacing)
+    {
+        int16_t x1 = std::max(0, k - h);
+        int16_t y1 = k - x1 - 1;
+        int16_t x2 = std::min(w, k) - 1;
+        int16_t y2 = k - x2;
+        drawLine(x0 + x1, y0 + y1, x0 + x2, y0 + y2, color);
+    }
+}
+
+void PlotSurface::drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off)
+{
+    if (on == 0)
+        return;
+    for (int16_t i = 0; i < length; i += on + off)
+        drawFastHLine(x0 + i, y0, std::min<int16_t>(on, length - i), color);
+}
+
+void PlotSurface::drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off)
+{
+    if (on == 0)
+        return;
+    for (int16_t i = 0; i < length; i += on + off)
+        drawFastVLine(x0, y0 + i, std::min<int16_t>(on, length - i), color);
+}
+
+void PlotSurface::drawSprite(int16_t x, int16_t y, const Sprite &sprite)
+{
+    for (uint8_t c = 0; c < sprite.colors; c++)
+    {
+        for (int16_t row = 0; row < sprite.h; row++)
+        {
+            for (int16_t col = 0; col < sprite.w; col++)
+            {
+                if (sprite.rows[c][row] & (0x8000 >> col))
+                    drawPixel(x + sprite.x + col, y + sprite.y + row, sprite.color[c]);
+            }
+        }
+    }
+}
+
+bool Sprite::operator==(const Sprite &other) const
+{
+    return x == other.x && y == other.y && w == other.w && h == other.h && colors == other.colors &&
+           memcmp(color, other.color, sizeof(color)) == 0 && memcmp(rows, other.rows, sizeof(rows)) == 0;
+}
+
+SpriteRecorder::SpriteRecorder()
+    : PlotSurface(Sprite::MAX_SIZE, Sprite::MAX_SIZE) {}
+
+void SpriteRecorder::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    x += ORIGIN;
+    y += ORIGIN;
+    if (x < 0 || y < 0 || x >= Sprite::MAX_SIZE || y >= Sprite::MAX_SIZE)
+        return;
+
+    uint8_t c = 0;
+    while (c < _drawn.colors && _drawn.color[c] != color)
+        c++;
+    if (c == Sprite::MAX_COLORS)
+        return;
+    if (c == _drawn.colors)
+        _drawn.color[_drawn.colors++] = color;
+
+    // A pixel drawn again takes the color it was drawn last
+    uint16_t bit = 0x8000 >> x;
+    for (uint8_t other = 0; other < _drawn.colors; other++)
+        _drawn.rows[other][y] &= ~bit;
+    _drawn.rows[c][y] |= bit;
+}
+
+Sprite SpriteRecorder::sprite() const
+{
+    int16_t top = Sprite::MAX_SIZE, bottom = -1;
+    uint16_t columns = 0;
+    for (int16_t row = 0; row < Sprite::MAX_SIZE; row++)
+    {
+        uint16_t any = 0;
+        for (uint8_t c = 0; c < _drawn.colors; c++)
+            any |= _drawn.rows[c][row];
+        if (any)
+        {
+            top = std::min(top, row);
+            bottom = row;
+            columns |= any;
+        }
+    }
+
+    Sprite trimmed;
+    if (bottom < 0)
+        return trimmed;
+    int16_t left = 0, right = Sprite::MAX_SIZE - 1;
+    while (!(columns & (0x8000 >> left)))
+        left++;
+    while (!(columns & (0x8000 >> right)))
+        right--;
+
+    trimmed.x = left - ORIGIN;
+    trimmed.y = top - ORIGIN;
+    trimmed.w = right - left + 1;
+    trimmed.h = bottom - top + 1;
+    // Colors left without a pixel are dropped
+    for (uint8_t c = 0; c < _drawn.colors; c++)
+    {
+        uint16_t any = 0;
+        for (int16_t row = top; row <= bottom; row++)
+            any |= _drawn.rows[c][row];
+        if (!any)
+            continue;
+        uint8_t t = trimmed.colors++;
+        trimmed.color[t] = _drawn.color[c];
+        for (int16_t row = top; row <= bottom; row++)
+            trimmed.rows[t][row - top] = _drawn.rows[c][row] << left;
+    }
+    return trimmed;
+}
@@ -0,0 +1,72 @@
+#ifndef PLOT_SURFACE_H
+#define PLOT_SURFACE_H
+
+#include <Adafruit_GFX.h>
+
+/**
+ * @brief A small bitmap in up to four colors, drawn around a point.
+ *
+ * Made once with SpriteRecorder and then drawn with
+ * PlotSurface::drawSprite as often as needed, as for plot markers.
+ */
+struct Sprite {
+    static const int16_t MAX_SIZE = 16;
+    static const uint8_t MAX_COLORS = 4;
+
+    int8_t x = 0, y = 0; // top left, relative to the point drawn at
+    uint8_t w = 0, h = 0;
+    uint8_t colors = 0;
+    uint16_t color[MAX_COLORS] = {};
+    uint16_t rows[MAX_COLORS][MAX_SIZE] = {}; // pixels of each color, leftmost in bit 15
+
+    bool operator==(const Sprite &other) const;
+};
+
+/**
+ * @brief Adafruit_GFX plus the pattern fills and dashed lines the plots use.
+ *
+ * The defaults draw them with plain Adafruit_GFX calls, one pixel or line
+ * at a time. FrameCanvas overrides them to write spans straight into its
+ * buffer, and DisplayList records each as a single entry. A rectangle
+ * without width or height draws nothing.
+ */
+class PlotSurface : public Adafruit_GFX {
+public:
+    PlotSurface(int16_t w, int16_t h) : Adafruit_GFX(w, h) {}
+
+    // color1 where (x - x0) + (y - y0) is odd, color2 elsewhere
+    virtual void fillChecker(int16_t x0, int16_t y0, int16_t w, int16_t h, uint16_t color1, uint16_t color2);
+
+    // Rising diagonal lines every spacing pixels across the rectangle, the
+    // first spacing pixels in from its top left corner
+    virtual void fillHatch(int16_t x0, int16_t y0, int16_t w, int16_t h, int16_t spacing, uint16_t color);
+
+    // length pixels from x0, y0 to the right (or down), on pixels drawn and
+    // off pixels skipped in turn, starting with a dash
+    virtual void drawDashedHLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off);
+    virtual void drawDashedVLine(int16_t x0, int16_t y0, int16_t length, uint16_t color, uint8_t on, uint8_t off);
+
+    virtual void drawSprite(int16_t x, int16_t y, const Sprite &sprite);
+};
+
+/**
+ * @brief Surface that turns whatever is drawn around 0, 0 into a Sprite.
+ *
+ * Pixels more than MAX_SIZE / 2 from the origin, and colors past
+ * MAX_COLORS, are dropped.
+ */
+class SpriteRecorder : public PlotSurface {
+public:
+    SpriteRecorder();
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+
+    // What has been drawn, trimmed to its bounds
+    Sprite sprite() const;
+
+private:
+    static const int16_t ORIGIN = Sprite::MAX_SIZE / 2;
+    Sprite _drawn; // untrimmed, origin at ORIGIN, ORIGIN
+};
+
+#endif
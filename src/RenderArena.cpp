@@ -0,0 +1,68 @@
+#include "RenderArena.h"
+#include <algorithm>
+#include <esp_heap_caps.h>
+
+RenderArena::~RenderArena()
+{
+    releaseBlocks();
+}
+
+void RenderArena::reset(size_t expected)
+{
+    // Whole kilobytes, so estimates a few bytes apart keep the same block
+    size_t wanted = (std::max(expected, _highWater) + 1023) & ~(size_t)1023;
+    if (_blocks.size() != 1 || _blocks[0].size < wanted)
+    {
+        releaseBlocks();
+        if (wanted > 0)
+            addBlock(wanted);
+    }
+    else
+    {
+        _blocks[0].used = 0;
+    }
+    _used = 0;
+}
+
+void *RenderArena::allocate(size_t bytes, size_t align)
+{
+    if (!_blocks.empty())
+    {
+        Block &block = _blocks.back();
+        size_t start = (block.used + align - 1) & ~(align - 1);
+        if (start + bytes <= block.size)
+        {
+            _used += start + bytes - block.used;
+            _highWater = std::max(_highWater, _used);
+            block.used = start + bytes;
+            return block.data + start;
+        }
+    }
+    // Block memory is aligned for any type, so a new one needs no padding
+    addBlock(std::max(bytes, MIN_BLOCK));
+    Block &block = _blocks.back();
+    block.used = bytes;
+    _used += bytes;
+    _highWater = std::max(_highWater, _used);
+    return block.data;
+}
+
+void RenderArena::addBlock(size_t size)
+{
+    void *data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!data)
+        data = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    if (!data)
+    {
+        Serial.println("[RenderArena] Out of memory!");
+        abort();
+    }
+    _blocks.push_back({(uint8_t *)data, size, 0});
+}
+
+void RenderArena::releaseBlocks()
+{
+    for (const Block &block : _blocks)
+        heap_caps_free(block.data);
+    _blocks.clear();
+}
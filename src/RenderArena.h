@@ -0,0 +1,92 @@
+#ifndef RENDER_ARENA_H
+#define RENDER_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+#include "PetHistory.h"
+
+/**
+ * @brief Bump allocator in PSRAM for the buffers a frame is drawn from.
+ *
+ * Allocations only move a pointer on and are never freed one by one;
+ * reset() at the start of each frame takes everything back at once. The
+ * block is kept from frame to frame and sized at reset() from what the
+ * frame is expected to need. Should a frame need more, the rest comes from
+ * extra blocks, and the next reset() grows the block to the most any frame
+ * used, so from then on a frame is served from one block.
+ */
+class RenderArena {
+public:
+    RenderArena() = default;
+    ~RenderArena();
+    RenderArena(const RenderArena &) = delete;
+    RenderArena &operator=(const RenderArena &) = delete;
+
+    // Drop everything allocated so far. expected is the frame's estimate in
+    // bytes; the block is made at least that big, and as big as the most any
+    // frame used so far.
+    void reset(size_t expected = 0);
+
+    void *allocate(size_t bytes, size_t align);
+
+    // Bytes handed out since the last reset, and the most in any one frame
+    size_t used() const { return _used; }
+    size_t highWater() const { return _highWater; }
+
+private:
+    struct Block {
+        uint8_t *data;
+        size_t size;
+        size_t used;
+    };
+
+    // Extra blocks are at least this big, so a frame that overruns its
+    // estimate does not take one per allocation
+    static const size_t MIN_BLOCK = 16 * 1024;
+
+    std::vector<Block> _blocks; // the frame's block first, then any extra ones
+    size_t _used = 0;
+    size_t _highWater = 0;
+
+    void addBlock(size_t size);
+    void releaseBlocks();
+};
+
+// STL allocator drawing from a RenderArena. deallocate() does nothing, so a
+// vector that grows leaves its old storage behind until the next reset: size
+// them up front. Without an arena it falls back to PsramAllocator.
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+    // A vector assigned from one built on the arena ends up on the arena too
+    typedef std::true_type propagate_on_container_copy_assignment;
+    typedef std::true_type propagate_on_container_move_assignment;
+    typedef std::true_type propagate_on_container_swap;
+
+    RenderArena *arena = nullptr;
+
+    ArenaAllocator(RenderArena *arena = nullptr) : arena(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n) {
+        if (arena == nullptr) return PsramAllocator<T>().allocate(n);
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *p, size_t n) {
+        if (arena == nullptr) PsramAllocator<T>().deallocate(p, n);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena == b.arena; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) { return a.arena != b.arena; }
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,217 @@
+#include "RtcCache.h"
+#include "Crc32.h"
+#include <algorithm>
+
+namespace {
+
+    struct __attribute__((packed)) CachedPet {
+        int32_t id;
+        char name[RtcCache::NAME_LEN];
+    };
+
+    struct __attribute__((packed)) CachedStatus {
+        uint8_t boxFull;
+        uint8_t sandLack;
+        int16_t litterPercent;
+        uint32_t timestamp;
+        char deviceName[RtcCache::NAME_LEN];
+        char deviceType[RtcCache::NAME_LEN];
+    };
+
+    struct __attribute__((packed)) RecentRecord {
+        uint32_t timestamp;
+        int32_t petId;
+        uint16_t weightGrams;
+        uint16_t durationSeconds;
+    };
+
+    struct HotData {
+        uint32_t magic;
+        uint32_t crc;          // over everything after this field
+        uint8_t petCount;      // 0 = not cached
+        uint8_t hasStatus;
+        uint8_t hasLatest;
+        uint8_t reserved;
+        CachedPet pets[RtcCache::MAX_PETS];
+        CachedStatus status;
+        uint32_t latestTimestamp;
+        uint32_t coveredFrom;  // recent holds every stored record at or after this; 0 = none
+        uint16_t recentCount;
+        RecentRecord recent[RtcCache::MAX_RECENT]; // oldest first
+    };
+
+    const uint32_t HOT_MAGIC = 0x43544850; // "PHTC"
+
+    // Survives deep sleep; zeroed on power-on, which fails the magic check
+    RTC_DATA_ATTR HotData hot;
+
+    uint32_t checksum() {
+        const uint8_t *start = (const uint8_t *)&hot + offsetof(HotData, petCount);
+        return crc32(start, sizeof(HotData) - offsetof(HotData, petCount));
+    }
+
+    void copyString(char *dest, const String &src) {
+        strncpy(dest, src.c_str(), RtcCache::NAME_LEN - 1);
+        dest[RtcCache::NAME_LEN - 1] = '\0';
+    }
+
+    uint16_t clamp16(int32_t v) {
+        return (uint16_t)std::min<int32_t>(std::max<int32_t>(v, 0), UINT16_MAX);
+    }
+
+    // Drop the oldest timestamp, and every record sharing it, from the front
+    void dropOldest() {
+        uint32_t ts = hot.recent[0].timestamp;
+        uint16_t n = 0;
+        while (n < hot.recentCount && hot.recent[n].timestamp == ts) n++;
+        memmove(hot.recent, hot.recent + n, (hot.recentCount - n) * sizeof(RecentRecord));
+        hot.recentCount -= n;
+        hot.coveredFrom = ts + 1;
+    }
+
+}
+
+void RtcCache::begin() {
+    if (hot.magic == HOT_MAGIC && hot.crc == checksum()) {
+        Serial.printf("[RtcCache] Valid: %u pets, %u recent records.\r\n", hot.petCount, hot.recentCount);
+        return;
+    }
+    Serial.println("[RtcCache] Empty or corrupt, starting fresh.");
+    memset(&hot, 0, sizeof(hot));
+    hot.magic = HOT_MAGIC;
+    commit();
+}
+
+void RtcCache::commit() {
+    hot.crc = checksum();
+}
+
+bool RtcCache::getPets(std::vector<Pet> &pets) const {
+    if (hot.petCount == 0) return false;
+    pets.clear();
+    for (uint8_t i = 0; i < hot.petCount; i++) {
+        Pet pet;
+        pet.id = hot.pets[i].id;
+        pet.name = hot.pets[i].name;
+        pets.push_back(pet);
+    }
+    return true;
+}
+
+void RtcCache::setPets(const std::vector<Pet> &pets) {
+    hot.petCount = std::min(pets.size(), MAX_PETS);
+    for (uint8_t i = 0; i < hot.petCount; i++) {
+        hot.pets[i].id = pets[i].id;
+        copyString(hot.pets[i].name, pets[i].name);
+    }
+    commit();
+}
+
+bool RtcCache::getStatus(StatusRecord &status) const {
+    if (!hot.hasStatus) return false;
+    status.box_full = hot.status.boxFull;
+    status.sand_lack = hot.status.sandLack;
+    status.litter_percent = hot.status.litterPercent;
+    status.timestamp = hot.status.timestamp;
+    status.device_name = hot.status.deviceName;
+    status.device_type = hot.status.deviceType;
+    return true;
+}
+
+void RtcCache::setStatus(const StatusRecord &status) {
+    hot.status.boxFull = status.box_full;
+    hot.status.sandLack = status.sand_lack;
+    hot.status.litterPercent = status.litter_percent;
+    hot.status.timestamp = status.timestamp;
+    copyString(hot.status.deviceName, status.device_name);
+    copyString(hot.status.deviceType, status.device_type);
+    hot.hasStatus = 1;
+    commit();
+}
+
+bool RtcCache::getLatestTimestamp(time_t &latest) const {
+    if (!hot.hasLatest) return false;
+    latest = hot.latestTimestamp;
+    return true;
+}
+
+void RtcCache::setLatestTimestamp(time_t latest) {
+    hot.latestTimestamp = latest;
+    hot.hasLatest = 1;
+    commit();
+}
+
+bool RtcCache::covers(time_t since) const {
+    return hot.coveredFrom != 0 && since >= (time_t)hot.coveredFrom;
+}
+
+size_t RtcCache::fill(PetDataMap &petData, time_t since, const std::vector<int> &petIds) const {
+    size_t filled = 0;
+    for (uint16_t i = 0; i < hot.recentCount; i++) {
+        const RecentRecord &rec = hot.recent[i];
+        if ((time_t)rec.timestamp < since) continue;
+        if (!petIds.empty() && std::find(petIds.begin(), petIds.end(), rec.petId) == petIds.end()) continue;
+        petData[rec.petId].insert(rec.timestamp, rec.weightGrams, rec.durationSeconds);
+        filled++;
+    }
+    return filled;
+}
+
+void RtcCache::seed(const PetDataMap &petData, time_t since) {
+    std::vector<RecentRecord> all;
+    for (const PetSeries &series : petData) {
+        for (size_t i = series.lowerBound(since); i < series.size(); i++) {
+            all.push_back({(uint32_t)series.timestamp(i), series.petId(), clamp16(series.weight(i)), clamp16(series.duration(i))});
+        }
+    }
+    std::sort(all.begin(), all.end(), [](const RecentRecord &a, const RecentRecord &b) {
+        return a.timestamp < b.timestamp;
+    });
+
+    hot.coveredFrom = std::max<time_t>(since, 1);
+    size_t start = all.size() > MAX_RECENT ? all.size() - MAX_RECENT : 0;
+    if (start > 0) {
+        // Coverage starts after the newest record left out, including any that share its timestamp
+        hot.coveredFrom = all[start - 1].timestamp + 1;
+        while (start < all.size() && all[start].timestamp < hot.coveredFrom) start++;
+    }
+    hot.recentCount = all.size() - start;
+    std::copy(all.begin() + start, all.end(), hot.recent);
+    commit();
+}
+
+void RtcCache::addRecords(const LitterboxRecord *records, size_t count) {
+    // Without a seed there is no telling what else belongs alongside these
+    if (hot.coveredFrom == 0) return;
+
+    for (size_t j = 0; j < count; j++) {
+        if (records[j].timestamp < (time_t)hot.coveredFrom) continue;
+        RecentRecord rec = {(uint32_t)records[j].timestamp, records[j].pet_id,
+                            clamp16(records[j].weight_grams), clamp16(records[j].duration_seconds)};
+
+        RecentRecord *end = hot.recent + hot.recentCount;
+        RecentRecord *pos = std::lower_bound(hot.recent, end, rec, [](const RecentRecord &a, const RecentRecord &b) {
+            return a.timestamp < b.timestamp;
+        });
+        while (pos < end && pos->timestamp == rec.timestamp && pos->petId != rec.petId) pos++;
+        if (pos < end && pos->timestamp == rec.timestamp) {
+            *pos = rec;
+            continue;
+        }
+
+        if (hot.recentCount == MAX_RECENT) {
+            size_t index = pos - hot.recent;
+            uint16_t before = hot.recentCount;
+            dropOldest();
+            // Dropped records all sort before pos, or rec is now too old to keep
+            size_t dropped = before - hot.recentCount;
+            if (rec.timestamp < hot.coveredFrom) continue;
+            pos = hot.recent + (index - dropped);
+            end = hot.recent + hot.recentCount;
+        }
+        memmove(pos + 1, pos, (end - pos) * sizeof(RecentRecord));
+        *pos = rec;
+        hot.recentCount++;
+    }
+    commit();
+}
@@ -0,0 +1,56 @@
+#ifndef RTC_CACHE_H
+#define RTC_CACHE_H
+
+#include <Arduino.h>
+#include <vector>
+#include "PetKitApi.h"
+#include "PetHistory.h"
+
+/**
+ * @brief Copy of the small, hot state kept in RTC slow memory across deep sleep.
+ *
+ * Holds the pet registry, the latest status, the newest stored timestamp and
+ * the most recent records, so a wake can skip SD and NVS for them. The data
+ * is checked against a CRC on every wake; after a power-on or a mismatch it
+ * starts empty and each part is filled in again as it is read from the card.
+ * Only records that made it to the card are added, so the cache never holds
+ * more than the card does.
+ */
+class RtcCache {
+public:
+    static constexpr size_t MAX_PETS = 8;
+    static constexpr size_t MAX_RECENT = 192;
+    static constexpr size_t NAME_LEN = 32;
+
+    // Validate the RTC copy, resetting it if it does not check out
+    void begin();
+
+    bool getPets(std::vector<Pet> &pets) const;
+    void setPets(const std::vector<Pet> &pets);
+
+    bool getStatus(StatusRecord &status) const;
+    void setStatus(const StatusRecord &status);
+
+    // Newest timestamp on the card, or false if not known yet
+    bool getLatestTimestamp(time_t &latest) const;
+    void setLatestTimestamp(time_t latest);
+
+    // True if the recent records include every stored record at or after since
+    bool covers(time_t since) const;
+
+    // Copy the recent records at or after since into petData, limited to
+    // petIds if not empty.
+    size_t fill(PetDataMap &petData, time_t since, const std::vector<int> &petIds) const;
+
+    // Replace the recent records with the newest ones in petData, which must
+    // hold every stored record of every pet from since onwards.
+    void seed(const PetDataMap &petData, time_t since);
+
+    // Add records just written to the card. The oldest are dropped when full.
+    void addRecords(const LitterboxRecord *records, size_t count);
+
+private:
+    void commit();
+};
+
+#endif
@@ -1,7 +1,10 @@
 // ScatterPlot.cpp
 
 #include "ScatterPlot.h"
+#include "Clock.h"
 #include <time.h> // For timestamp formatting
+#include <algorithm>
+#include <array>
 #include <Fonts/FreeSans9pt7b.h>
 #include <Fonts/FreeSansBold12pt7b.h>
 
@@ -16,12 +19,19 @@ const int PLOT_BLACK = 0;
 const int PLOT_WHITE = 15;
 
 // Constructor: Initializes the plot with its position and a reference to the framebuffer
-ScatterPlot::ScatterPlot(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *disp, int x, int y, int width, int height)
-    : display(disp), _x(x), _y(y), _width(width), _height(height) {}
+ScatterPlot::ScatterPlot(PlotSurface *disp, int x, int y, int width, int height, RenderArena *arena)
+    : display(disp), _x(x), _y(y), _width(width), _height(height), _arena(arena), _series(arena) {}
 
 
-void ScatterPlot::addSeries(const String& name, const std::vector<DataPoint>& data, uint16_t color, uint16_t bgcolor, int xticks, int yticks) {
-    _series.push_back({name, data, color, bgcolor});
+void ScatterPlot::addSeries(const String& name, Span<DataPoint> data, uint16_t color, uint16_t bgcolor, int xticks, int yticks) {
+    _series.push_back({name, data, color, bgcolor, false});
+    _xticks = xticks;
+    _yticks = yticks;
+}
+
+void ScatterPlot::addSeries(const String& name, Span<DataPoint> data, int32_t xMin, int32_t xMax, float yMin, float yMax,
+                            uint16_t color, uint16_t bgcolor, int xticks, int yticks) {
+    _series.push_back({name, data, color, bgcolor, true, xMin, xMax, yMin, yMax});
     _xticks = xticks;
     _yticks = yticks;
 }
@@ -46,9 +56,10 @@ void ScatterPlot::draw()
         drawLegend();
         return; // Nothing to draw
     }
-    float xMin = 1.0e38, xMax = -1.0e38, yMin = 1.0e38, yMax = -1.0e38;
+    int32_t xMin = INT32_MAX, xMax = INT32_MIN;
+    float yMin = 1.0e38, yMax = -1.0e38;
 
-    auto findMinMax = [&](const std::vector<DataPoint> &data)
+    auto findMinMax = [&](Span<DataPoint> data)
     {
         for (const auto &p : data)
         {
@@ -61,18 +72,32 @@ void ScatterPlot::draw()
     
     // Iterate over all series to find global min/max
     for (const auto& s : _series) {
-        findMinMax(s.data);
+        if (!s.bounded) {
+            findMinMax(s.data);
+        } else if (!s.data.empty()) {
+            xMin = std::min(xMin, s.xMin);
+            xMax = std::max(xMax, s.xMax);
+            yMin = std::min(yMin, s.yMin);
+            yMax = std::max(yMax, s.yMax);
+        }
+    }
+    // Series without a single point in them: the range is still unset
+    if (xMin > xMax)
+    {
+        drawAxes(0, 10, 0, 10);
+        drawLegend();
+        return;
     }
 
     // Add a 5% padding to the ranges
-    float xRange = xMax - xMin;
+    int32_t xRange = xMax - xMin;
     float yRange = yMax - yMin;
-    xMin -= xRange * 0.05;
-    xMax += xRange * 0.05;
+    xMin -= xRange / 20;
+    xMax += xRange / 20;
     yMin -= yRange * 0.05;
     yMax += yRange * 0.05;
 
-    if (xMax == xMin) { xMax += 1.0; xMin -= 1.0; }
+    if (xMax == xMin) { xMax += 1; xMin -= 1; }
     if (yMax == yMin) { yMax += 1.0; yMin -= 1.0; }
 
     // 2. Clear the plot area (fill with white)
@@ -82,10 +107,9 @@ void ScatterPlot::draw()
     drawAxes(xMin, xMax, yMin, yMax);
     plotDataPoints(xMin, xMax, yMin, yMax);
     drawLegend();
-    add_refresh_timestamp();
 }
 
-void ScatterPlot::drawAxes(float xMin, float xMax, float yMin, float yMax)
+void ScatterPlot::drawAxes(int32_t xMin, int32_t xMax, float yMin, float yMax)
 {
     int plotAreaX = _x + MARGIN_LEFT;
     int plotAreaY = _y + MARGIN_TOP;
@@ -121,7 +145,7 @@ void ScatterPlot::drawAxes(float xMin, float xMax, float yMin, float yMax)
 
     // --- Draw X-Axis Ticks and Labels ---
     const int numXTicks = _xticks;
-    time_t now = time(NULL);
+    time_t now = Clock::now();
     struct tm *midnight_tomorrow = localtime(&now);
     midnight_tomorrow->tm_hour = 0;
     midnight_tomorrow->tm_min = 0;
@@ -135,7 +159,7 @@ void ScatterPlot::drawAxes(float xMin, float xMax, float yMin, float yMax)
         time_t tickTime = midnight - (time_t)((float)i * seconds_per_xtick);
         struct tm* thisticktime = localtime(&tickTime);
         time_t adjustedticktime = mktime(thisticktime);
-        DataPoint tickpoint = {(float)adjustedticktime, 0.0 };
+        DataPoint tickpoint = {(int32_t)(adjustedticktime - _origin), 0.0 };
         int xPos, yPos;
         mapPoint(tickpoint, xPos, yPos, xMin, xMax, yMin, yMax);
         if((xPos < plotAreaX) || (xPos > plotAreaX + plotAreaWidth)) continue;
@@ -176,27 +200,152 @@ void ScatterPlot::drawAxes(float xMin, float xMax, float yMin, float yMax)
     // X-Axis label (was missing in original)
 }
 
-void ScatterPlot::mapPoint(const DataPoint &p, int &screenX, int &screenY, float xMin, float xMax, float yMin, float yMax)
+void ScatterPlot::mapPoint(const DataPoint &p, int &screenX, int &screenY, int32_t xMin, int32_t xMax, float yMin, float yMax)
 {
         int plotAreaX = _x + MARGIN_LEFT;
         int plotAreaY = _y + MARGIN_TOP;
         int plotAreaWidth = _width - MARGIN_LEFT - MARGIN_RIGHT;
         int plotAreaHeight = _height - MARGIN_TOP - MARGIN_BOTTOM;
-        screenX = plotAreaX + ((p.x - xMin) / (xMax - xMin)) * plotAreaWidth;
+        // In whole seconds; the product needs 64 bits past about 30 days at 800 px
+        screenX = plotAreaX + (int)((int64_t)(p.x - xMin) * plotAreaWidth / (xMax - xMin));
         screenY = (plotAreaY + plotAreaHeight) - ((p.y - yMin) / (yMax - yMin)) * plotAreaHeight;
 }
 
-void ScatterPlot::plotDataPoints(float xMin, float xMax, float yMin, float yMax)
+void ScatterPlot::plotDataPoints(int32_t xMin, int32_t xMax, float yMin, float yMax)
 {
-    // Loop over all series and plot their points
-    for (const auto& s : _series) {
-        for (const auto &p : s.data)
+    // Each series' marker is rasterized once, then stamped at every point
+    ArenaVector<Sprite> sprites(_arena);
+    ArenaVector<PlacedMarker> markers(_arena);
+    sprites.reserve(_series.size());
+    markers.reserve(pointCount()); // never more markers than points
+    for (size_t i = 0; i < _series.size(); i++)
+    {
+        sprites.push_back(markerSprite(_series[i].color, _series[i].background));
+        placeMarkers(i, markers, xMin, xMax, yMin, yMax);
+    }
+    if (_decimation != DECIMATE_NONE)
+        dropHiddenMarkers(markers, sprites);
+
+    for (const auto &m : markers)
+        display->drawSprite(m.x, m.y, sprites[m.series]);
+    _markersDrawn = markers.size();
+}
+
+void ScatterPlot::placeMarkers(uint8_t series, ArenaVector<PlacedMarker> &out, int32_t xMin, int32_t xMax, float yMin, float yMax)
+{
+    Span<DataPoint> data = _series[series].data;
+    if (_decimation != DECIMATE_ENVELOPE)
+    {
+        for (const auto &p : data)
         {
             int sx, sy;
             mapPoint(p, sx, sy, xMin, xMax, yMin, yMax);
-            drawMarker(sx, sy, s.color, s.background);
+            out.push_back({(int16_t)sx, (int16_t)sy, series});
+        }
+        return;
+    }
+
+    // Highest and lowest point of each column, left to right. mapPoint can
+    // land on the far edge itself; anything off the plot area is kept as is.
+    int plotAreaX = _x + MARGIN_LEFT;
+    int cols = _width - MARGIN_LEFT - MARGIN_RIGHT + 1;
+    ArenaVector<std::pair<int16_t, int16_t>> span(cols, {INT16_MAX, INT16_MIN}, _arena);
+    for (const auto &p : data)
+    {
+        int sx, sy;
+        mapPoint(p, sx, sy, xMin, xMax, yMin, yMax);
+        if (sx < plotAreaX || sx >= plotAreaX + cols)
+        {
+            out.push_back({(int16_t)sx, (int16_t)sy, series});
+            continue;
+        }
+        auto &column = span[sx - plotAreaX];
+        column.first = std::min<int16_t>(column.first, sy);
+        column.second = std::max<int16_t>(column.second, sy);
+    }
+    for (int c = 0; c < cols; c++)
+    {
+        if (span[c].first > span[c].second)
+            continue;
+        out.push_back({(int16_t)(plotAreaX + c), span[c].first, series});
+        if (span[c].second != span[c].first)
+            out.push_back({(int16_t)(plotAreaX + c), span[c].second, series});
+    }
+}
+
+// Every pixel ends up the color of the last marker drawn on it, so a marker
+// whose pixels all get drawn over by later ones changes nothing. Going from
+// the last marker back, a bitmap of the pixels already claimed tells which
+// those are.
+void ScatterPlot::dropHiddenMarkers(ArenaVector<PlacedMarker> &markers, const ArenaVector<Sprite> &sprites)
+{
+    // The plot area and as far as a marker reaches past it, 32 columns a word
+    const int reach = Sprite::MAX_SIZE / 2;
+    int left = _x + MARGIN_LEFT - reach, top = _y + MARGIN_TOP - reach;
+    int cols = _width - MARGIN_LEFT - MARGIN_RIGHT + 1 + 2 * reach;
+    int rows = _height - MARGIN_TOP - MARGIN_BOTTOM + 1 + 2 * reach;
+    int words = (cols + 31) / 32 + 1; // the spare word takes a row running past the last
+    ArenaVector<uint32_t> claimed((size_t)words * rows, 0, _arena);
+
+    // Each sprite's pixels in any of its colors
+    ArenaVector<std::array<uint16_t, Sprite::MAX_SIZE>> shapes(sprites.size(), _arena);
+    for (size_t i = 0; i < sprites.size(); i++)
+    {
+        shapes[i].fill(0);
+        for (uint8_t c = 0; c < sprites[i].colors; c++)
+        {
+            for (int r = 0; r < sprites[i].h; r++)
+                shapes[i][r] |= sprites[i].rows[c][r];
+        }
+    }
+
+    size_t kept = markers.size();
+    for (size_t i = markers.size(); i-- > 0;)
+    {
+        const PlacedMarker m = markers[i];
+        const Sprite &sprite = sprites[m.series];
+        int x0 = m.x + sprite.x - left, y0 = m.y + sprite.y - top;
+        bool inside = x0 >= 0 && y0 >= 0 && x0 + sprite.w <= cols && y0 + sprite.h <= rows;
+        if (inside)
+        {
+            bool hidden = true;
+            for (int r = 0; r < sprite.h; r++)
+            {
+                // The row's pixels across the two words they can fall in
+                uint64_t bits = (uint64_t)shapes[m.series][r] << (48 - (x0 & 31));
+                uint32_t *word = &claimed[(size_t)(y0 + r) * words + (x0 >> 5)];
+                uint32_t hi = bits >> 32, lo = (uint32_t)bits;
+                hidden &= (word[0] & hi) == hi && (word[1] & lo) == lo;
+                word[0] |= hi;
+                word[1] |= lo;
+            }
+            if (hidden)
+                continue;
         }
+        // Pushed down against the end, in drawing order
+        markers[--kept] = m;
     }
+    markers.erase(markers.begin(), markers.begin() + kept);
+}
+
+size_t ScatterPlot::scratchBytes(size_t points, int width, int height)
+{
+    // The markers, the claimed bitmap of dropHiddenMarkers and the columns
+    // of the envelope; sprites and shapes are a few hundred bytes at most
+    const int reach = Sprite::MAX_SIZE / 2;
+    int cols = width - MARGIN_LEFT - MARGIN_RIGHT + 1 + 2 * reach;
+    int rows = height - MARGIN_TOP - MARGIN_BOTTOM + 1 + 2 * reach;
+    size_t bitmap = (size_t)((cols + 31) / 32 + 1) * rows * sizeof(uint32_t);
+    size_t columns = (size_t)cols * sizeof(std::pair<int16_t, int16_t>);
+    return points * sizeof(PlacedMarker) + bitmap + columns;
+}
+
+size_t ScatterPlot::pointCount() const
+{
+    size_t count = 0;
+    for (const auto &s : _series)
+        count += s.data.size();
+    return count;
 }
 
 void ScatterPlot::drawLegend() {
@@ -212,7 +361,7 @@ void ScatterPlot::drawLegend() {
     
     for (const auto& s : _series) {
         display->getTextBounds(s.name, legendX, legendY, &x1, &y1, &w, &h);
-        drawMarker(legendX + markerw/2, legendY + markerh/2, s.color, s.background);
+        display->drawSprite(legendX + markerw/2, legendY + markerh/2, markerSprite(s.color, s.background));
         //display->fillRect(legendX, legendY, markerw, markerh, s.color);
         display->setCursor(legendX + markerw + 5,  _y + MARGIN_TOP/2 + h/2);
         display->print(s.name);
@@ -222,38 +371,45 @@ void ScatterPlot::drawLegend() {
     }
 }
 
-void ScatterPlot::drawMarker(int x, int y, uint16_t color, uint16_t background)
+void ScatterPlot::drawMarker(PlotSurface &surface, int x, int y, uint16_t color, uint16_t background)
 {
     #if (EPD_SELECT == 1002)
         // You could customize this to draw different markers based on series index
         // For now, all series use a filled circle
-        display->fillCircle(x, y, 3, background);
-        display->drawCircle(x, y, 3, color);
-        display->drawCircle(x, y, 1, color);
+        surface.fillCircle(x, y, 3, background);
+        surface.drawCircle(x, y, 3, color);
+        surface.drawCircle(x, y, 1, color);
         
     #elif (EPD_SELECT == 1001)
         switch(color)
         {
             case EPD_RED:
-                display->fillCircle(x, y, 3, EPD_BLACK);
+                surface.fillCircle(x, y, 3, EPD_BLACK);
             break;
             case EPD_BLUE:
-                display->drawCircle(x, y, 3, EPD_BLACK);
+                surface.drawCircle(x, y, 3, EPD_BLACK);
             break;
             case EPD_GREEN:
-                display->drawRect(x-1, y+1, 4, 4, EPD_BLACK);
+                surface.drawRect(x-1, y+1, 4, 4, EPD_BLACK);
             break;
             case EPD_YELLOW:
-                display->fillRect(x-1, y+1, 4, 4, EPD_BLACK);
+                surface.fillRect(x-1, y+1, 4, 4, EPD_BLACK);
             break;
             case EPD_BLACK:
-                display->drawLine(x-2, y+2, x+2, y-2, EPD_BLACK);
-                display->drawLine(x+1, y-1, x-1, y+1, EPD_BLACK);
+                surface.drawLine(x-2, y+2, x+2, y-2, EPD_BLACK);
+                surface.drawLine(x+1, y-1, x-1, y+1, EPD_BLACK);
             break;
         }
     #endif
 }
 
+Sprite ScatterPlot::markerSprite(uint16_t color, uint16_t background)
+{
+    SpriteRecorder recorder;
+    drawMarker(recorder, 0, 0, color, background);
+    return recorder.sprite();
+}
+
 // Helper function to simplify drawing text
 void ScatterPlot::drawString(int x, int y, const String &text, const GFXfont *font, uint8_t color)
 {
@@ -264,28 +420,6 @@ void ScatterPlot::drawString(int x, int y, const String &text, const GFXfont *fo
     display->print(text);
 }
 
-void ScatterPlot::add_refresh_timestamp()
-{
-    time_t now;
-    struct tm timeinfo;
-    char strftime_buf[64]; // Buffer to hold the formatted string
-
-    int16_t x = 0, y = 0, x1 = 0, y1 = 0;
-    uint16_t w = 0, h = 0;
-
-    time(&now);                   // Get current epoch time
-    localtime_r(&now, &timeinfo); // Convert to struct tm
-    strftime(strftime_buf, sizeof(strftime_buf), "%m/%d/%y %H:%M", &timeinfo);
-    display->setFont(NULL);
-    display->setTextSize(1);
-    display->getTextBounds(strftime_buf, x, y, &x1, &y1, &w, &h);
-    x = EPD_WIDTH - MARGIN_RIGHT - w;
-    
-    drawString(x, h/2, strftime_buf, NULL, EPD_BLACK); // Use NULL font for default
-
-    
-}
-
 void ScatterPlot::drawDashedLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, uint16_t dashLength, uint16_t spaceLength)
 {
     // Ensure dash and space lengths are positive to avoid infinite loops
@@ -295,6 +429,21 @@ void ScatterPlot::drawDashedLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1,
         return;
     }
 
+    // Grid lines run right or down and go to the surface as whole dashed
+    // lines: each dash covers its end point too, and the last dash starts
+    // before x1 (or y1)
+    if (dashLength + spaceLength <= 255 && ((y0 == y1 && x1 >= x0) || (x0 == x1 && y1 >= y0)))
+    {
+        int16_t length = (x1 - x0) + (y1 - y0);
+        if (length % (dashLength + spaceLength) != 0)
+            length++;
+        if (y0 == y1)
+            display->drawDashedHLine(x0, y0, length, color, dashLength + 1, spaceLength - 1);
+        else
+            display->drawDashedVLine(x0, y0, length, color, dashLength + 1, spaceLength - 1);
+        return;
+    }
+
     // Calculate the total length of the line
     float dx = x1 - x0;
     float dy = y1 - y0;
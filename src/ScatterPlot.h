@@ -12,36 +12,52 @@
 #include <GxEPD2_BW.h>
 #endif
 #include <Fonts/FreeMonoBold9pt7b.h>
+#include "PlotSurface.h"
+#include "RenderArena.h"
+#include "Span.h"
 
 
-// A simple struct to hold a single data point
+// A simple struct to hold a single data point. x is a time in seconds from
+// the plot's time origin (see ScatterPlot::setTimeOrigin), so it keeps
+// whole-second precision where a float of the Unix time would not.
 struct DataPoint {
-    float x;
+    int32_t x;
     float y;
 };
 
 // A struct to hold all info for a single series
 struct PlotSeries {
     String name;
-    std::vector<DataPoint> data;
+    Span<DataPoint> data; // the caller's, not copied
     uint16_t color;
     uint16_t background;
-    float xMin, xMax;
+    bool bounded; // xMin to yMax hold the extent of data
+    int32_t xMin, xMax;
     float yMin, yMax;
 };
 
 class ScatterPlot {
 public:
-    // Constructor
-    ScatterPlot(GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)>* disp, int x, int y, int width, int height);
+    // Constructor. The series and the scratch buffers of draw() come from
+    // arena, or the heap if there is none.
+    ScatterPlot(PlotSurface* disp, int x, int y, int width, int height, RenderArena* arena = nullptr);
 
     /**
      * @brief Add a data series to be plotted.
      * @param name The name of the series (for the legend).
-     * @param data A vector of DataPoints for the series.
+     * @param data The points of the series. Not copied: they have to stay
+     *             where they are until draw() has run.
      * @param color The color to use for this series' markers.
      */
-    void addSeries(const String& name, const std::vector<DataPoint>& data, uint16_t color, uint16_t bgcolor, int xticks, int yticks);
+    void addSeries(const String& name, Span<DataPoint> data, uint16_t color, uint16_t bgcolor, int xticks, int yticks);
+
+    // As above, for a series whose extent the caller already knows, so draw()
+    // need not go over its points for it
+    void addSeries(const String& name, Span<DataPoint> data, int32_t xMin, int32_t xMax, float yMin, float yMax,
+                   uint16_t color, uint16_t bgcolor, int xticks, int yticks);
+
+    // Unix time that DataPoint::x counts from; the start of the range plotted
+    void setTimeOrigin(int64_t origin) { _origin = origin; }
 
     // Set labels for the plot
     void setLabels(const String& title, const String& xLabel, const String& yLabel);
@@ -52,26 +68,53 @@ public:
     // Helper to draw text easily
     void drawString(int x, int y, const String& text, const GFXfont* font, uint8_t color);
 
+    // How the points of a series are thinned out before their markers are drawn
+    enum Decimation {
+        DECIMATE_NONE,      // every point
+        DECIMATE_OCCUPANCY, // markers later ones cover completely left out (looks the same)
+        DECIMATE_ENVELOPE,  // per pixel column, only the highest and lowest point of a series, then as above
+    };
+    void setDecimation(Decimation mode) { _decimation = mode; }
+
+    // Markers the last draw() put down, and the points they stood for
+    size_t markersDrawn() const { return _markersDrawn; }
+    size_t pointCount() const;
+
+    // Arena bytes draw() takes for this many points on a plot of this size,
+    // for sizing the arena up front
+    static size_t scratchBytes(size_t points, int width, int height);
+
 private:
     // Framebuffer and plot dimensions
-    GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)>* display;
+    PlotSurface* display;
     int _x, _y, _width, _height;
     int _xticks, _yticks;
+    RenderArena* _arena;
     // Plot data and labels
-    std::vector<PlotSeries> _series; // Use a vector of series
+    ArenaVector<PlotSeries> _series; // Use a vector of series
     String _title, _xLabel, _yLabel;
+    int64_t _origin = 0;
+    Decimation _decimation = DECIMATE_OCCUPANCY;
+    size_t _markersDrawn = 0;
+
+    struct PlacedMarker {
+        int16_t x, y;
+        uint8_t series;
+    };
 
     // Helper functions for drawing
-    void drawAxes(float xMin, float xMax, float yMin, float yMax);
-    void plotDataPoints(float xMin, float xMax, float yMin, float yMax);
+    void drawAxes(int32_t xMin, int32_t xMax, float yMin, float yMax);
+    void plotDataPoints(int32_t xMin, int32_t xMax, float yMin, float yMax);
     void drawLegend();
     void drawDashedLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color, uint16_t dashLength, uint16_t spaceLength);
-    void mapPoint(const DataPoint &p, int &screenX, int &screenY, float xMin, float xMax, float yMin, float yMax);
+    void mapPoint(const DataPoint &p, int &screenX, int &screenY, int32_t xMin, int32_t xMax, float yMin, float yMax);
+    // Markers for the points of one series, appended in drawing order
+    void placeMarkers(uint8_t series, ArenaVector<PlacedMarker> &out, int32_t xMin, int32_t xMax, float yMin, float yMax);
+    void dropHiddenMarkers(ArenaVector<PlacedMarker> &markers, const ArenaVector<Sprite> &sprites);
     // Generic marker drawing function
-    void drawMarker(int x, int y, uint16_t color, uint16_t background);
-
-    //add the present time to show when display last refreshed
-    void add_refresh_timestamp();
+    void drawMarker(PlotSurface &surface, int x, int y, uint16_t color, uint16_t background);
+    // The marker centred on 0, 0, as drawn for each point
+    Sprite markerSprite(uint16_t color, uint16_t background);
 };
 
 #endif // SCATTER_PLOT_H
@@ -3,14 +3,10 @@
 
 #include <Arduino.h>
 #include <vector>
-#include <map>
 #include "PetKitApi.h" // Ensure this library is available
 
-// Forward declaration to avoid including full heavy headers if possible
-// but for these structs we usually need the definitions.
-
-// Define the structure for our data map: PetID -> Timestamp -> Record
-typedef std::map<int, std::map<time_t, LitterboxRecord>> PetDataMap;
+// Our data map: PetID -> records sorted by timestamp (see PetHistory.h)
+#include "PetHistory.h"
 
 enum DateRangeEnum {
   LAST_7_DAYS,
@@ -24,6 +20,7 @@ struct DateRangeInfo {
   DateRangeEnum type;
   char name[32];
   long seconds;
+  bool daily; // draw from the per-day rollups rather than every visit
 };
 
 // Global constants for NVS keys
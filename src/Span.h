@@ -0,0 +1,33 @@
+#ifndef SPAN_H
+#define SPAN_H
+
+#include <stddef.h>
+
+/**
+ * @brief Read-only view of values stored elsewhere, as std::span in C++20.
+ *
+ * The widgets take their series as spans over the caller's buffers, which
+ * have to outlive the draw.
+ */
+template <typename T>
+class Span {
+public:
+    Span() = default;
+    Span(const T *data, size_t size) : _data(data), _size(size) {}
+    // Any contiguous container: std::vector, PsramVector
+    template <typename Container>
+    Span(const Container &values) : _data(values.data()), _size(values.size()) {}
+
+    const T *data() const { return _data; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+    const T &operator[](size_t i) const { return _data[i]; }
+    const T *begin() const { return _data; }
+    const T *end() const { return _data + _size; }
+
+private:
+    const T *_data = nullptr;
+    size_t _size = 0;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "WakeProfiler.h"
+#include "Crc32.h"
+#include "Clock.h"
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+
+void WakeProfiler::begin(uint8_t wakeCause) {
+    _record = {};
+    _record.wakeCause = wakeCause;
+    _record.totalInternal = heap_caps_get_total_size(MALLOC_CAP_INTERNAL);
+    _record.totalPsram = heap_caps_get_total_size(MALLOC_CAP_SPIRAM);
+    _lastMarkUs = 0;
+}
+
+void WakeProfiler::mark(Phase phase) {
+    int64_t nowUs = esp_timer_get_time();
+    PhaseSample &sample = _record.phases[phase];
+    sample.durationUs += (uint32_t)(nowUs - _lastMarkUs);
+    sample.minFreeInternal = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+    sample.minFreePsram = heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM);
+    _lastMarkUs = nowUs;
+}
+
+bool WakeProfiler::save(fs::FS &fs) {
+    if (!fs.exists(_logDir)) {
+        fs.mkdir(_logDir);
+    }
+
+    LogHeader header = {};
+    File file = fs.open(_logFilename, "r+");
+    bool valid = file && file.read((uint8_t *)&header, sizeof(header)) == sizeof(header) &&
+                 header.magic == LOG_MAGIC && header.version == LOG_VERSION &&
+                 header.recordSize == sizeof(WakeRecord) && header.phaseCount == PHASE_COUNT &&
+                 header.capacity == LOG_CAPACITY && header.next < LOG_CAPACITY;
+    if (!valid) {
+        // Missing, or from another layout: start over
+        if (file) file.close();
+        Serial.println("[WakeProfiler] Starting a new wake log.");
+        header = {LOG_MAGIC, LOG_VERSION, sizeof(WakeRecord), PHASE_COUNT, LOG_CAPACITY, 0, 0, 0};
+        file = fs.open(_logFilename, FILE_WRITE);
+        if (!file || file.write((const uint8_t *)&header, sizeof(header)) != sizeof(header)) {
+            Serial.println("[WakeProfiler] Failed to create the wake log!");
+            if (file) file.close();
+            return false;
+        }
+    }
+
+    _record.sequence = header.sequence;
+    _record.timestamp = Clock::now();
+    _record.crc = crc32(&_record, offsetof(WakeRecord, crc));
+
+    // The record goes in before the header moves on, so a torn write only
+    // ever damages the slot the next wake overwrites anyway
+    bool ok = file.seek(sizeof(header) + (size_t)header.next * sizeof(WakeRecord)) &&
+              file.write((const uint8_t *)&_record, sizeof(_record)) == sizeof(_record);
+    if (ok) {
+        header.next = (header.next + 1) % LOG_CAPACITY;
+        if (header.count < LOG_CAPACITY) header.count++;
+        header.sequence++;
+        ok = file.seek(0) && file.write((const uint8_t *)&header, sizeof(header)) == sizeof(header);
+    }
+    file.close();
+    if (!ok) Serial.println("[WakeProfiler] Wake log write failed!");
+    return ok;
+}
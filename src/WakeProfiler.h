@@ -0,0 +1,96 @@
+#ifndef WAKE_PROFILER_H
+#define WAKE_PROFILER_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+/**
+ * @brief Per-phase timing and memory use of one wake, kept in a ring log on SD.
+ *
+ * mark() closes the phase that just ran: the time since the previous mark
+ * (esp_timer, so from boot for the first) is added to it, along with the
+ * lowest free internal heap and PSRAM seen so far. Phases a wake skips stay
+ * at zero. save() appends the wake as one CRC-checked record to
+ * /logs/wake.bin, overwriting the oldest once the log is full.
+ * tools/wake_log.py turns the log into per-phase percentiles.
+ */
+class WakeProfiler {
+public:
+    // Order matters: it is the record layout and what the decoder expects
+    enum Phase : uint8_t {
+        INIT,         // hardware, NVS, SD mount, stored status
+        WIFI,         // connect or provision
+        TIME_SYNC,    // NTP and RTC
+        API_LOGIN,
+        FETCH,
+        SAVE,         // load the fetched window, merge, journal, status
+        LOAD,         // pets and history for the view
+        RENDER,       // drawing, or loading a cached frame
+        REFRESH,      // sending the frame and the panel refresh
+        SHUTDOWN,     // panel hibernate, up to the log write
+        PHASE_COUNT
+    };
+
+    enum Flag : uint8_t {
+        VIEW_UPDATE = 1 << 0,
+        WIFI_OK = 1 << 1,
+        CACHED_FRAME = 1 << 2,
+        NEW_RECORDS = 1 << 3,
+        UNCHANGED = 1 << 4, // panel left as it was
+        PARTIAL_REFRESH = 1 << 5, // only the status bar window refreshed
+    };
+
+    void begin(uint8_t wakeCause);
+    void mark(Phase phase);
+    void setFlag(Flag flag) { _record.flags |= flag; }
+    void setBatteryMilliVolts(uint16_t mv) { _record.batteryMilliVolts = mv; }
+    // Most of PlotManager's render arena a frame used
+    void setRenderArenaBytes(uint32_t bytes) { _record.renderArenaBytes = bytes; }
+
+    // Append this wake to the ring log on fs. Returns false if it could not be written.
+    bool save(fs::FS &fs);
+
+private:
+    struct __attribute__((packed)) PhaseSample {
+        uint32_t durationUs;
+        uint32_t minFreeInternal; // lowest since boot when the phase ended
+        uint32_t minFreePsram;
+    };
+
+    struct __attribute__((packed)) WakeRecord {
+        uint32_t sequence;
+        uint32_t timestamp;
+        uint16_t batteryMilliVolts;
+        uint8_t wakeCause; // esp_sleep_wakeup_cause_t
+        uint8_t flags;
+        uint32_t totalInternal;
+        uint32_t totalPsram;
+        uint32_t renderArenaBytes; // 0 if no frame was drawn
+        PhaseSample phases[PHASE_COUNT];
+        uint32_t crc; // CRC32 of everything above
+    };
+
+    // Header, then `capacity` WakeRecord slots
+    struct __attribute__((packed)) LogHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint16_t phaseCount;
+        uint16_t capacity;
+        uint16_t next;     // slot the next record goes to
+        uint16_t count;    // slots holding a record
+        uint32_t sequence; // of the next record
+    };
+
+    static const uint32_t LOG_MAGIC = 0x4C574B50; // "PKWL"
+    static const uint16_t LOG_VERSION = 2;
+    static const uint16_t LOG_CAPACITY = 1024; // about 12 weeks of 2-hourly wakes
+
+    WakeRecord _record = {};
+    int64_t _lastMarkUs = 0;
+
+    const char *_logDir = "/logs";
+    const char *_logFilename = "/logs/wake.bin";
+};
+
+#endif
@@ -1,6 +1,5 @@
 #ifndef CONFIG_H__
 #define CONFIG_H__
-#include "WiFiProvisioner.h"
 
 #define EPD_WIDTH 800
 #define EPD_HEIGHT 480
@@ -46,7 +45,10 @@ const int BUTTON_KEY2 = 5; // KEY2 - GPIO5
 // Select the ePaper driver to use
 // 0: reTerminal E1001 (7.5'' B&W)
 // 1: reTerminal E1002 (7.3'' Color)
+// Can be set from build_flags, as the native environments do
+#ifndef EPD_SELECT
 #define EPD_SELECT 1001
+#endif
 
 #if (EPD_SELECT == 1001)
 #define GxEPD2_DISPLAY_CLASS GxEPD2_BW
@@ -63,7 +65,32 @@ const int BUTTON_KEY2 = 5; // KEY2 - GPIO5
          ? EPD::HEIGHT                                         \
          : MAX_DISPLAY_BUFFER_SIZE / (EPD::WIDTH / 8))
 
+// Rows of the frame rasterized at a time. The whole panel by default;
+// fewer replay the recorded plots once per page into a smaller buffer
+// (the E1002's 4 bit frame takes 192000 bytes).
+#ifndef FRAME_PAGE_ROWS
+#define FRAME_PAGE_ROWS EPD_HEIGHT
+#endif
+
+// Status bar updates the B&W panel takes as partial refreshes before the
+// next full refresh clears the ghosting they leave behind
+#ifndef PARTIAL_REFRESH_LIMIT
+#define PARTIAL_REFRESH_LIMIT 6
+#endif
+
+// How old the status bar clock may get on a panel without partial refresh,
+// where it only goes out with a full frame
+#ifndef STATUS_CLOCK_MAX_MINUTES
+#define STATUS_CLOCK_MAX_MINUTES 180
+#endif
+
 #define GRAMS_PER_POUND 453.592
+
+// History retention on the SD card
+#define DATA_RETENTION_SECONDS (365 * 86400L)
+
+// Most history PetKit will return for one request
+#define MAX_FETCH_DAYS 30
 #define NVS_NAMESPACE "petkitplotter"
 #define NVS_TZ_KEY "timezone"
 #define NVS_PLOT_TYPE_KEY "plottype"
@@ -5,25 +5,44 @@
 #include <Fonts/FreeSansBold12pt7b.h>
 #include <Fonts/FreeSansBold9pt7b.h>
 
-Histogram::Histogram(Adafruit_GFX *gfx, int16_t x, int16_t y, int16_t w, int16_t h)
-    : _gfx(gfx), _x(x), _y(y), _w(w), _h(h) {}
+Histogram::Histogram(PlotSurface *gfx, int16_t x, int16_t y, int16_t w, int16_t h, RenderArena *arena)
+    : _gfx(gfx), _x(x), _y(y), _w(w), _h(h), _arena(arena), _series(arena) {}
 
 void Histogram::setTitle(const char *title) { _title = title; }
 void Histogram::setXAxisLabel(const char *label) { _xAxisLabel = label; }
 void Histogram::setYAxisLabel(const char *label) { _yAxisLabel = label; }
 void Histogram::setBinCount(int bins) { _numBins = bins > 0 ? bins : 1; }
 
-void Histogram::addSeries(const char *name, const std::vector<float> &data, uint16_t color, uint16_t background)
+void Histogram::addSeries(const char *name, Span<float> data, uint16_t color, uint16_t background)
 {
     // Add a new series to our vector, initializing seriesMaxFreq to 0
-    HistogramSeries newSeries;
+    HistogramSeries &newSeries = _series.emplace_back();
     newSeries.name = name;
     newSeries.data = data;
-    newSeries.bins = std::vector<int>(); // Explicitly create empty vector
+    newSeries.valueCount = data.size();
+    newSeries.bins = ArenaVector<int>(_arena);
     newSeries.color = color;
     newSeries.seriesMaxFreq = 0;
     newSeries.backcolor = background;
-    _series.push_back(newSeries);
+}
+
+void Histogram::addSeries(const char *name, Span<float> data, float minValue, float maxValue, uint16_t color, uint16_t background)
+{
+    addSeries(name, data, color, background);
+    HistogramSeries &newSeries = _series.back();
+    newSeries.bounded = true;
+    newSeries.minValue = minValue;
+    newSeries.maxValue = maxValue;
+}
+
+void Histogram::addBucketedSeries(const char *name, Span<uint32_t> buckets, float bucketWidth, float maxValue, uint16_t color, uint16_t background)
+{
+    addSeries(name, Span<float>(), 0.0f, maxValue, color, background);
+    HistogramSeries &newSeries = _series.back();
+    newSeries.buckets = buckets;
+    newSeries.bucketWidth = bucketWidth;
+    for (uint32_t count : buckets)
+        newSeries.valueCount += count;
 }
 
 void Histogram::setNormalization(bool enabled)
@@ -61,7 +80,14 @@ void Histogram::processData()
 
     for (const auto &s : _series)
     {
-        if (!s.data.empty())
+        if (s.valueCount == 0)
+            continue;
+        if (s.bounded)
+        {
+            _minVal = std::min(_minVal, s.minValue);
+            _maxVal = std::max(_maxVal, s.maxValue);
+        }
+        else
         {
             _minVal = std::min(_minVal, *std::min_element(s.data.begin(), s.data.end()));
             _maxVal = std::max(_maxVal, *std::max_element(s.data.begin(), s.data.end()));
@@ -84,7 +110,7 @@ void Histogram::processData()
     {
         s.bins.assign(_numBins, 0);
         s.seriesMaxFreq = 0; // Reset series-specific max
-        if (s.data.empty())
+        if (s.valueCount == 0)
             continue;
 
         for (float val : s.data)
@@ -97,6 +123,8 @@ void Histogram::processData()
                 s.bins[binIndex]++;
             }
         }
+        if (!s.buckets.empty())
+            binBuckets(s, binWidth);
 
         // Find the max frequency for *this* series
         if (!s.bins.empty())
@@ -104,8 +132,8 @@ void Histogram::processData()
             float maxBin = (float)*std::max_element(s.bins.begin(), s.bins.end());
             if (_normalize)
             {
-                if (s.data.size() > 0) {
-                    s.seriesMaxFreq = (int)((maxBin * 100.0f) / s.data.size());
+                if (s.valueCount > 0) {
+                    s.seriesMaxFreq = (int)((maxBin * 100.0f) / s.valueCount);
                 } else {
                     s.seriesMaxFreq = 0;
                 }
@@ -138,6 +166,52 @@ void Histogram::processData()
     }
 }
 
+// A bucket's values are taken to be spread evenly over it and shared out
+// between the bins it overlaps in proportion. The last bucket is open ended,
+// so its values go where the largest one is. Shares are rounded to whole
+// counts by largest remainder, so the bins still add up to valueCount.
+void Histogram::binBuckets(HistogramSeries &s, float binWidth)
+{
+    ArenaVector<float> shares(_numBins, 0.0f, _arena);
+    size_t lastBucket = s.buckets.size() - 1;
+    uint32_t total = 0;
+    for (size_t b = 0; b <= lastBucket; b++)
+    {
+        if (s.buckets[b] == 0)
+            continue;
+        total += s.buckets[b];
+        float lo = b == lastBucket ? s.maxValue : std::min(b * s.bucketWidth, s.maxValue);
+        float hi = b == lastBucket ? s.maxValue : std::min((b + 1) * s.bucketWidth, s.maxValue);
+        int first = std::min(std::max(static_cast<int>((lo - _minVal) / binWidth), 0), _numBins - 1);
+        int last = std::min(static_cast<int>((hi - _minVal) / binWidth), _numBins - 1);
+        if (hi <= lo || first >= last)
+        {
+            shares[first] += s.buckets[b];
+            continue;
+        }
+        for (int bin = first; bin <= last; bin++)
+        {
+            float from = std::max(lo, _minVal + bin * binWidth);
+            float to = bin == last ? hi : std::min(hi, _minVal + (bin + 1) * binWidth);
+            shares[bin] += s.buckets[b] * (to - from) / (hi - lo);
+        }
+    }
+
+    ArenaVector<int> order(_numBins, 0, _arena);
+    uint32_t assigned = 0;
+    for (int bin = 0; bin < _numBins; bin++)
+    {
+        int whole = static_cast<int>(floorf(shares[bin]));
+        s.bins[bin] += whole;
+        shares[bin] -= whole;
+        assigned += whole;
+        order[bin] = bin;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return shares[a] > shares[b]; });
+    for (int i = 0; assigned < total && i < _numBins; i++, assigned++)
+        s.bins[order[i]]++;
+}
+
 void Histogram::drawAxes()
 {
     // Define the actual plotting area inside paddings
@@ -272,8 +346,8 @@ void Histogram::drawBars()
                 if (s.seriesMaxFreq > 0)
                 {
                     // Calculate height as a percentage of this series's max
-                    if (s.data.size() > 0) {
-                        float freq = (static_cast<float>(s.bins[i]) / s.data.size()) * 100.0;
+                    if (s.valueCount > 0) {
+                        float freq = (static_cast<float>(s.bins[i]) / s.valueCount) * 100.0;
                          barH = static_cast<int16_t>((freq / _maxFreq) * _plotH);
                     }
                 }
@@ -373,23 +447,8 @@ void Histogram::drawPatternRect(int16_t x, int16_t y, int16_t w, int16_t h,  uin
     if (w <= 0 || h <= 0)
         return;
 
-    // Draw diagonal fill lines /// by drawing parallel lines of the form x-y=k.
-    // We iterate k through the box dimensions and calculate the clipped start
-    // and end points for the line segment that falls within the rectangle.
-    for (int16_t k = 4; k < w + h; k += 4)
-    { // Start at 4 to not draw on the border
-
-        // Calculate the start point (bottom-left of the line segment)
-        int16_t x1_rel = std::max(0, k - h);
-        int16_t y1_rel = k - x1_rel - 1;
-
-        // Calculate the end point (top-right of the line segment)
-        int16_t x2_rel = std::min(w, k) - 1;
-        int16_t y2_rel = k - x2_rel;
-
-        // Convert relative coordinates to absolute screen coordinates and draw the line.
-        _gfx->drawLine(x + x1_rel, y + y1_rel, x + x2_rel, y + y2_rel, EPD_BLACK);
-    }
+    // Diagonal fill lines ///, starting 4 in so as not to draw on the border
+    _gfx->fillHatch(x, y, w, h, 4, EPD_BLACK);
 }
 
 void Histogram::drawHatchRect(int16_t x, int16_t y, int16_t w, int16_t h,  uint16_t color1, uint16_t color2)
@@ -400,37 +459,12 @@ void Histogram::drawHatchRect(int16_t x, int16_t y, int16_t w, int16_t h,  uint1
     if (w <= 0 || h <= 0)
         return;
 
-    // Draw diagonal fill lines /// by drawing parallel lines of the form x-y=k.
-    // We iterate k through the box dimensions and calculate the clipped start
-    // and end points for the line segment that falls within the rectangle.
-    for (int16_t k = 4; k < w + h; k += 4)
-    { // Start at 4 to not draw on the border
-
-        // Calculate the start point (bottom-left of the line segment)
-        int16_t x1_rel = std::max(0, k - h);
-        int16_t y1_rel = k - x1_rel - 1;
-
-        // Calculate the end point (top-right of the line segment)
-        int16_t x2_rel = std::min(w, k) - 1;
-        int16_t y2_rel = k - x2_rel;
-
-        // Convert relative coordinates to absolute screen coordinates and draw the line.
-        _gfx->drawLine(x + x1_rel, y + y1_rel, x + x2_rel, y + y2_rel, EPD_BLACK);
-    }
+    // Diagonal fill lines ///, starting 4 in so as not to draw on the border
+    _gfx->fillHatch(x, y, w, h, 4, EPD_BLACK);
 }
 
 void Histogram::drawCheckerRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color1, uint16_t color2)
 {
-    bool checker = false;
-    for (int y1 = y; y1 < y + h; y1++)
-    {
-        for (int x1 = x; x1 < x + w; x1++)
-        {
-            if (checker ^ ((x1 - x) % 2))
-                _gfx->drawPixel(x1, y1, color1);
-            else _gfx->drawPixel(x1, y1, color2);
-        }
-        checker = !checker;
-    }
+    _gfx->fillChecker(x, y, w, h, color1, color2);
     _gfx->drawRect(x, y, w, h, color1);
-}
\ No newline at end of file
+}
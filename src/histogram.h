@@ -7,12 +7,21 @@
 #include <GxEPD2_BW.h>
 #endif
 #include <vector>
+#include "PlotSurface.h"
+#include "RenderArena.h"
+#include "Span.h"
 
 
  struct HistogramSeries {
         const char* name;
-        std::vector<float> data;
-        std::vector<int> bins;
+        Span<float> data; // the caller's, not copied
+        Span<uint32_t> buckets; // or counts of values per bucketWidth from zero
+        float bucketWidth = 0.0f;
+        size_t valueCount = 0;
+        ArenaVector<int> bins;
+        bool bounded = false; // minValue and maxValue hold the extent of data
+        float minValue = 0.0f;
+        float maxValue = 0.0f;
         uint16_t color;
         uint16_t backcolor;
         int seriesMaxFreq = 0; // Max frequency for this specific series
@@ -22,13 +31,15 @@ class Histogram {
 public:
     /**
      * @brief Construct a new Epaper Histogram object
-     * @param gfx Pointer to your initialized Adafruit_GFX compatible display object.
+     * @param gfx Pointer to the surface to draw on.
      * @param x The x-coordinate for the top-left corner of the chart area.
      * @param y The y-coordinate for the top-left corner of the chart area.
      * @param w The width of the chart area.
      * @param h The height of the chart area.
+     * @param arena Where the series and bins are kept while drawing; the
+     *              heap if none.
      */
-    Histogram(Adafruit_GFX* gfx, int16_t x, int16_t y, int16_t w, int16_t h);
+    Histogram(PlotSurface* gfx, int16_t x, int16_t y, int16_t w, int16_t h, RenderArena* arena = nullptr);
 
     /**
      * @brief Set the main title of the histogram.
@@ -57,10 +68,27 @@ public:
     /**
      * @brief Add a data series to be plotted.
      * @param name The name of the series (for the legend).
-     * @param data A vector of floats for the data series.
+     * @param data The values of the series. Not copied: they have to stay
+     *             where they are until plot() has run.
      * @param color The color to use for this series' bars.
      */
-    void addSeries(const char* name, const std::vector<float>& data, uint16_t color, uint16_t background);
+    void addSeries(const char* name, Span<float> data, uint16_t color, uint16_t background);
+
+    /**
+     * @brief Add a data series whose smallest and largest value the caller
+     * already knows, so plot() need not go over the values for them.
+     */
+    void addSeries(const char* name, Span<float> data, float minValue, float maxValue, uint16_t color, uint16_t background);
+
+    /**
+     * @brief Add a data series already counted into fixed-width buckets.
+     * @param buckets buckets[i] values fell in [i, i + 1) * bucketWidth; the
+     *                last may also hold larger ones. Not copied.
+     * @param maxValue The largest of the values. Each bucket's values are
+     *                 spread evenly over it and shared out between the bins
+     *                 it overlaps; the last bucket's are counted at maxValue.
+     */
+    void addBucketedSeries(const char* name, Span<uint32_t> buckets, float bucketWidth, float maxValue, uint16_t color, uint16_t background);
 
     /**
      * @brief Enable or disable normalization.
@@ -80,13 +108,14 @@ private:
    
 
     void processData();
+    void binBuckets(HistogramSeries &s, float binWidth);
     void drawAxes();
     void drawBars();
     void drawLegend();
     void drawPatternRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color1, uint16_t color2);
     void drawHatchRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color1, uint16_t color2);
     void drawCheckerRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color1, uint16_t color2);
-    Adafruit_GFX* _gfx;
+    PlotSurface* _gfx;
     int16_t _x, _y, _w, _h; // Overall widget position and size
 
     // Plotting area (inside the widget area, with padding for labels/title)
@@ -97,7 +126,8 @@ private:
     const char* _yAxisLabel = nullptr;
 
     int _numBins = 20;
-    std::vector<HistogramSeries> _series; // Use a vector of series
+    RenderArena* _arena;
+    ArenaVector<HistogramSeries> _series; // Use a vector of series
 
     float _minVal = 0.0f;
     float _maxVal = 0.0f;
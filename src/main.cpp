@@ -1,4 +1,5 @@
 #include <Arduino.h>
+#include <SD.h>
 #include "config.h"
 #include "SharedTypes.h"
 #include "DataManager.h"
@@ -6,6 +7,7 @@
 #include "PlotManager.h"
 #include "RTClib.h"
 #include "Adafruit_SHT4x.h"
+#include "WakeProfiler.h"
 
 // Globals
 GxEPD2_DISPLAY_CLASS<GxEPD2_DRIVER_CLASS, MAX_HEIGHT(GxEPD2_DRIVER_CLASS)> *display;
@@ -15,17 +17,19 @@ Adafruit_SHT4x sht4 = Adafruit_SHT4x();
 SPIClass hspi(HSPI);
 
 DataManager dataManager;
+WakeProfiler wakeProfiler;
 NetworkManager *networkManager;
 PlotManager *plotManager;
 
 PetDataMap allPetData;
+PetRollupMap allPetRollups;
 std::vector<Pet> allPets;
 
 DateRangeInfo dateRangeInfo[] = {
-    {LAST_7_DAYS, "Last 7 Days", 7 * 86400L},
-    {LAST_30_DAYS, "Last 30 Days", 30 * 86400L},
-    {LAST_90_DAYS, "Last 90 Days", 90 * 86400L},
-    {LAST_365_DAYS, "Last 365 Days", 365 * 86400L},
+    {LAST_7_DAYS, "Last 7 Days", 7 * 86400L, false},
+    {LAST_30_DAYS, "Last 30 Days", 30 * 86400L, false},
+    {LAST_90_DAYS, "Last 90 Days", 90 * 86400L, true},
+    {LAST_365_DAYS, "Last 365 Days", 365 * 86400L, true},
 };
 
 void initHardware()
@@ -75,12 +79,34 @@ void initHardware()
 
   // Pass the global hspi to the display
   display->epd2.selectSPI(hspi, SPISettings(4000000, MSBFIRST, SPI_MODE0));
-  display->init(0);
+  // A timer wake may only send the status bar window. Left initial, GxEPD2
+  // would clear the controller's RAM on the first write and turn the window
+  // refresh into a full one; a full frame is sent whole either way.
+  display->init(0, esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER);
 
   pinMode(LED_PIN, OUTPUT);
   digitalWrite(LED_PIN, LOW);
 }
 
+// The card's power and detect pins are set up in initHardware
+bool mountSd()
+{
+  delay(100);
+  if (digitalRead(SD_DET_PIN))
+  {
+    Serial.println("No SD card detected.");
+    return false;
+  }
+  // Shares the display's SPI bus
+  if (!SD.begin(SD_CS_PIN, hspi))
+  {
+    Serial.println("SD Mount Failed!");
+    return false;
+  }
+  Serial.println("SD Card Mounted.");
+  return true;
+}
+
 void checkFactoryReset() {
   // If Key 1 and Key 2 are held down at boot, wipe credentials
   if (digitalRead(BUTTON_KEY1) == LOW && digitalRead(BUTTON_KEY2) == LOW) {
@@ -100,6 +126,7 @@ void checkFactoryReset() {
 
 void setup()
 {
+  wakeProfiler.begin(esp_sleep_get_wakeup_cause());
   initHardware();
   preferences.begin(NVS_NAMESPACE);
 
@@ -107,10 +134,12 @@ void setup()
 
   networkManager = new NetworkManager(preferences);
   plotManager = new PlotManager(display);
+  plotManager->setProfiler(&wakeProfiler);
 
-  // 1. Load Local Data from Micro SD
-  dataManager.begin(hspi);
-  dataManager.loadData(allPetData);
+  // 1. Mount Micro SD. History is loaded below, once the clock is set and
+  // we know how far back this wake needs to look.
+  bool sdReady = mountSd();
+  dataManager.begin(SD);
 
   StatusRecord status = dataManager.getStatus();
 
@@ -148,33 +177,49 @@ void setup()
   }
 
   bool wifiSuccess = false;
+  bool frameShown = false;
+  bool dataLoaded = false;
+  size_t newRecords = 0;
+
+  wakeProfiler.mark(WakeProfiler::INIT);
+  if (isViewUpdate)
+    wakeProfiler.setFlag(WakeProfiler::VIEW_UPDATE);
 
   if (!isViewUpdate)
   {
-    networkManager->connectOrProvision(display);
+    if (networkManager->connectOrProvision(display))
+      plotManager->forgetShownFrame();
+    wakeProfiler.mark(WakeProfiler::WIFI);
     
     if(networkManager->syncTime(rtc)) wifiSuccess = true;
+    wakeProfiler.mark(WakeProfiler::TIME_SYNC);
+    if (wifiSuccess)
+      wakeProfiler.setFlag(WakeProfiler::WIFI_OK);
     
-    if (networkManager->initPetKitApi())
+    bool apiReady = networkManager->initPetKitApi();
+    wakeProfiler.mark(WakeProfiler::API_LOGIN);
+    if (apiReady)
     {
       //networkManager->getApi()->setDebug(true);
       // Calculate how many days we are missing
-      int daysToFetch = 30; // Default max
+      int daysToFetch = MAX_FETCH_DAYS; // Default max
 
-      time_t latestTimestamp = dataManager.getLatestTimestamp(allPetData);
+      time_t latestTimestamp = dataManager.getLatestTimestamp();
 
       if (latestTimestamp > 0)
       {
-        time_t now = time(NULL);
+        time_t now = Clock::now();
         long secondsDifference = now - latestTimestamp;
         Serial.printf("Latest timestamp from SD: %lu, %.2f days ago.\r\n", latestTimestamp, (float)secondsDifference / 86400.0);
 
         int daysDifference = (int)(secondsDifference / 86400) + 2; // +buffer
-        daysToFetch = std::min(std::max(daysDifference, 1), 30);
+        daysToFetch = std::min(std::max(daysDifference, 1), MAX_FETCH_DAYS);
       }
       Serial.printf("Requesting %d days of data from PetKit.\r\n", daysToFetch);
 
-      if (networkManager->getApi()->fetchAllData(daysToFetch))
+      bool fetched = networkManager->getApi()->fetchAllData(daysToFetch);
+      wakeProfiler.mark(WakeProfiler::FETCH);
+      if (fetched)
       {
         allPets = networkManager->getApi()->getPets();
 
@@ -182,46 +227,122 @@ void setup()
         if (!allPets.empty())
         {
           preferences.putBytes(NVS_PETS_KEY, allPets.data(), allPets.size() * sizeof(Pet));
+          dataManager.cachePets(allPets);
         }
+
+        // Load the fetched window so mergeData can recognise records already on the card,
+        // and the range on screen unless it is drawn from the daily rollups
+        long loadSeconds = (daysToFetch + 1) * 86400L;
+        if (!dateRangeInfo[rangeIndex].daily)
+          loadSeconds = std::max(dateRangeInfo[rangeIndex].seconds, loadSeconds);
+        dataManager.loadData(allPetData, Clock::now() - loadSeconds);
+        dataLoaded = true;
+
         // Merge data
         for (const auto &pet : allPets)
         {
           auto records = networkManager->getApi()->getLitterboxRecordsByPetId(pet.id);
-          dataManager.mergeData(allPetData, pet.id, records);
+          newRecords += dataManager.mergeData(allPetData, pet.id, records);
         }
-        dataManager.saveData(allPetData);
+        Serial.printf("%u new records from PetKit.\r\n", (unsigned)newRecords);
+        if (newRecords > 0)
+          dataManager.saveData();
         status = networkManager->getApi()->getLatestStatus();
         if (status.device_name.length() > 0)
         {
           dataManager.saveStatus(status);
         }
+        wakeProfiler.mark(WakeProfiler::SAVE);
+        if (newRecords > 0)
+          wakeProfiler.setFlag(WakeProfiler::NEW_RECORDS);
       }
     }
   }
   else
   {
-    // If we are just updating the view (button1 or 2 press), try to load pets from NVS
-    // so we have names for the charts without needing WiFi
     networkManager->initializeFromRtc(rtc);
-    size_t len = preferences.getBytesLength(NVS_PETS_KEY);
-    if (len > 0)
+    wakeProfiler.mark(WakeProfiler::TIME_SYNC);
+  }
+
+  if (!dataLoaded)
+  {
+    // View update (button1 or 2 press), or a refresh that fetched nothing.
+    // Pet names come from RTC memory, or NVS after a power cycle, so the charts need no WiFi
+    if (!dataManager.getCachedPets(allPets))
+    {
+      size_t len = preferences.getBytesLength(NVS_PETS_KEY);
+      if (len > 0)
+      {
+        allPets.resize(len / sizeof(Pet));
+        preferences.getBytes(NVS_PETS_KEY, allPets.data(), len);
+        dataManager.cachePets(allPets);
+      }
+    }
+  }
+
+  wakeProfiler.mark(WakeProfiler::LOAD);
+
+  // Nothing new since this view was last drawn: show it without touching the history
+  if (newRecords == 0)
+  {
+    plotManager->setFrameCache(sdReady ? &SD : nullptr, dataManager.getDataVersion(), allPets);
+    // On a timer wake a panel already showing this view only needs its
+    // status bar brought up to date. Button wakes always redraw.
+    PlotManager::StatusRefresh statusRefresh = PlotManager::STATUS_NEEDS_FRAME;
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER)
+      statusRefresh = plotManager->refreshStatus(dateRangeInfo[rangeIndex], status);
+
+    if (statusRefresh == PlotManager::STATUS_UNCHANGED)
+    {
+      frameShown = true;
+      wakeProfiler.setFlag(WakeProfiler::UNCHANGED);
+    }
+    else if (statusRefresh == PlotManager::STATUS_PARTIAL)
     {
-      allPets.resize(len / sizeof(Pet));
-      preferences.getBytes(NVS_PETS_KEY, allPets.data(), len);
+      frameShown = true;
+      wakeProfiler.setFlag(WakeProfiler::PARTIAL_REFRESH);
     }
+    else
+    {
+      frameShown = plotManager->showCachedFrame(dateRangeInfo[rangeIndex], status);
+      if (frameShown)
+        wakeProfiler.setFlag(WakeProfiler::CACHED_FRAME);
+    }
+  }
+
+  if (!frameShown && !dataLoaded && !dateRangeInfo[rangeIndex].daily)
+  {
+    // Only the selected range of the known pets is needed to draw the view
+    std::vector<int> petIds;
+    for (const auto &pet : allPets)
+      petIds.push_back(pet.id);
+    dataManager.loadData(allPetData, Clock::now() - dateRangeInfo[rangeIndex].seconds, petIds);
     //status = dataManager.getStatus();
   }
 
-  // 3. Render
-  plotManager->renderDashboard(allPets, allPetData, dateRangeInfo[rangeIndex], status, wifiSuccess, currentTemp, currentHumid);
+  if (!frameShown)
+  {
+    // Daily ranges read the per-day rollups, which already include anything merged above
+    if (dateRangeInfo[rangeIndex].daily)
+      dataManager.loadRollups(allPetRollups, Clock::now() - dateRangeInfo[rangeIndex].seconds);
+    wakeProfiler.mark(WakeProfiler::LOAD);
+
+    // 3. Render, caching the frame under the version just saved
+    plotManager->setFrameCache(sdReady ? &SD : nullptr, dataManager.getDataVersion(), allPets);
+    plotManager->renderDashboard(allPets, allPetData, allPetRollups, dateRangeInfo[rangeIndex], status, wifiSuccess, currentTemp, currentHumid);
+  }
 
-  display->display();
   display->hibernate();
 
   //check battery low, extend sleep duration if so
   int mv = analogReadMilliVolts(BATTERY_ADC_PIN);
   float battery_voltage = (mv / 1000.0) * 2;
 
+  wakeProfiler.setBatteryMilliVolts(mv * 2);
+  wakeProfiler.mark(WakeProfiler::SHUTDOWN);
+  if (sdReady)
+    wakeProfiler.save(SD);
+
   // 4. Sleep
   Serial.println("Sleeping...");
   uint64_t sleepInterval;
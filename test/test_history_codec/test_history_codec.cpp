@@ -0,0 +1,134 @@
+// HistoryCodec round trips on the host
+//   pio test -e native_test
+
+#include <limits.h>
+#include <unity.h>
+#include <vector>
+#include "../../src/HistoryCodec.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void assertSamplesEqual(const std::vector<HistorySample> &expected, const std::vector<HistorySample> &actual) {
+    TEST_ASSERT_EQUAL_UINT32(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        TEST_ASSERT_EQUAL_UINT32(expected[i].timestamp, actual[i].timestamp);
+        TEST_ASSERT_EQUAL_INT32(expected[i].weightGrams, actual[i].weightGrams);
+        TEST_ASSERT_EQUAL_INT32(expected[i].durationSeconds, actual[i].durationSeconds);
+    }
+}
+
+// Encodes samples, checks they decode back whole, and returns the block
+static std::vector<uint8_t> roundTrip(const std::vector<HistorySample> &samples) {
+    std::vector<uint8_t> block;
+    size_t written = HistoryCodec::encodeBlock(samples.data(), samples.size(), block);
+    TEST_ASSERT_EQUAL_UINT32(block.size(), written);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(HistoryCodec::maxBlockSize(samples.size()), block.size());
+
+    std::vector<HistorySample> decoded;
+    TEST_ASSERT_EQUAL_UINT32(block.size(), HistoryCodec::decodeBlock(block.data(), block.size(), decoded));
+    assertSamplesEqual(samples, decoded);
+    return block;
+}
+
+static void test_empty_input() {
+    std::vector<uint8_t> block = roundTrip({});
+    TEST_ASSERT_EQUAL_UINT32(1, block.size());
+
+    // Not even a count
+    std::vector<HistorySample> decoded;
+    TEST_ASSERT_EQUAL_UINT32(0, HistoryCodec::decodeBlock(block.data(), 0, decoded));
+    TEST_ASSERT_EQUAL_UINT32(0, decoded.size());
+}
+
+static void test_one_sample() {
+    roundTrip({{1749988800, 4520, 145}});
+    roundTrip({{0, 0, 0}});
+}
+
+static void test_typical_visits() {
+    std::vector<HistorySample> samples;
+    uint32_t ts = 1749988800;
+    int32_t weight = 4500;
+    for (int i = 0; i < 200; i++) {
+        ts += 3 * 3600 + (i * 7919) % 7200;
+        weight += (i * 31) % 61 - 30;
+        samples.push_back({ts, weight, 60 + (i * 13) % 240});
+    }
+    std::vector<uint8_t> block = roundTrip(samples);
+    // Delta-of-delta timestamps and weight deltas keep a visit to a few bytes
+    TEST_ASSERT_LESS_THAN_UINT32(8 * samples.size(), block.size());
+}
+
+static void test_large_deltas() {
+    roundTrip({{0, 0, 0}, {1, 1, 1}, {UINT32_MAX, 2, 2}});
+    roundTrip({{0, 0, 0}, {UINT32_MAX - 1, 0, 0}, {UINT32_MAX, 0, 0}});
+    roundTrip({{1000, INT32_MIN, 0}, {2000, INT32_MAX, 0}, {3000, INT32_MIN, 0}, {4000, 0, 0}});
+    roundTrip({{1000, 0, INT32_MAX}, {2000, 0, -1}, {3000, 0, INT32_MIN}});
+}
+
+static void test_zigzag_extremes() {
+    const int32_t values[] = {0, -1, 1, -2, 2, INT32_MAX, INT32_MIN, INT32_MIN + 1};
+    for (int32_t v : values)
+        TEST_ASSERT_EQUAL_INT32(v, HistoryCodec::unzigzag(HistoryCodec::zigzag(v)));
+    TEST_ASSERT_EQUAL_UINT32(0, HistoryCodec::zigzag(0));
+    TEST_ASSERT_EQUAL_UINT32(1, HistoryCodec::zigzag(-1));
+    TEST_ASSERT_EQUAL_UINT32(2, HistoryCodec::zigzag(1));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX - 1, HistoryCodec::zigzag(INT32_MAX));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, HistoryCodec::zigzag(INT32_MIN));
+}
+
+static void test_decode_appends() {
+    std::vector<HistorySample> samples = {{100, 4000, 60}, {200, 4010, 70}};
+    std::vector<uint8_t> block;
+    HistoryCodec::encodeBlock(samples.data(), samples.size(), block);
+    // Bytes after the block are left for the caller
+    block.push_back(0xAA);
+
+    std::vector<HistorySample> decoded = {{1, 2, 3}};
+    TEST_ASSERT_EQUAL_UINT32(block.size() - 1, HistoryCodec::decodeBlock(block.data(), block.size(), decoded));
+    assertSamplesEqual({{1, 2, 3}, {100, 4000, 60}, {200, 4010, 70}}, decoded);
+}
+
+static void test_truncated_block() {
+    std::vector<HistorySample> samples = {{1749988800, 4520, 145}, {1749999600, 4533, 90}, {1750010400, 4498, 300}};
+    std::vector<uint8_t> block;
+    HistoryCodec::encodeBlock(samples.data(), samples.size(), block);
+
+    // Every prefix is rejected and leaves out as it was
+    for (size_t length = 0; length < block.size(); length++) {
+        std::vector<HistorySample> decoded = {{1, 2, 3}};
+        TEST_ASSERT_EQUAL_UINT32(0, HistoryCodec::decodeBlock(block.data(), length, decoded));
+        assertSamplesEqual({{1, 2, 3}}, decoded);
+    }
+}
+
+static void test_corrupt_block() {
+    std::vector<HistorySample> decoded;
+
+    // A count larger than the block could hold
+    const uint8_t hugeCount[] = {0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 0, 0, 0};
+    TEST_ASSERT_EQUAL_UINT32(0, HistoryCodec::decodeBlock(hugeCount, sizeof(hugeCount), decoded));
+
+    // A varint that never ends
+    std::vector<uint8_t> endless(16, 0xFF);
+    TEST_ASSERT_EQUAL_UINT32(0, HistoryCodec::decodeBlock(endless.data(), endless.size(), decoded));
+
+    // Two samples claimed, the columns of one present
+    const uint8_t shortColumns[] = {0x02, 0x64, 0x00, 0x00};
+    TEST_ASSERT_EQUAL_UINT32(0, HistoryCodec::decodeBlock(shortColumns, sizeof(shortColumns), decoded));
+    TEST_ASSERT_EQUAL_UINT32(0, decoded.size());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_input);
+    RUN_TEST(test_one_sample);
+    RUN_TEST(test_typical_visits);
+    RUN_TEST(test_large_deltas);
+    RUN_TEST(test_zigzag_extremes);
+    RUN_TEST(test_decode_appends);
+    RUN_TEST(test_truncated_block);
+    RUN_TEST(test_corrupt_block);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""Decode the wake log (/logs/wake.bin on the SD card) written by WakeProfiler.
+
+Prints per-phase latency percentiles, the heap, PSRAM and render arena
+high-water marks and an estimate of the charge each wake draws.
+
+    python3 tools/wake_log.py /media/sd/logs/wake.bin
+    python3 tools/wake_log.py wake.bin --days 14 --kind refresh
+    python3 tools/wake_log.py wake.bin --current WIFI=130 --current REFRESH=45
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+import zlib
+
+LOG_MAGIC = 0x4C574B50  # "PKWL"
+LOG_VERSION = 2
+HEADER = struct.Struct("<IHHHHHHI")
+RECORD_HEAD = struct.Struct("<IIHBBIII")
+PHASE = struct.Struct("<III")
+
+# Must match WakeProfiler::Phase
+PHASES = ["INIT", "WIFI", "TIME_SYNC", "API_LOGIN", "FETCH", "SAVE",
+          "LOAD", "RENDER", "REFRESH", "SHUTDOWN"]
+
+FLAG_VIEW_UPDATE = 1 << 0
+FLAG_WIFI_OK = 1 << 1
+FLAG_CACHED_FRAME = 1 << 2
+FLAG_NEW_RECORDS = 1 << 3
+FLAG_UNCHANGED = 1 << 4
+FLAG_PARTIAL_REFRESH = 1 << 5
+
+# Rough ESP32-S3 board draw per phase in mA, for the charge estimate only.
+# Measure your own and pass --current to replace them.
+DEFAULT_CURRENT_MA = {
+    "INIT": 45, "WIFI": 120, "TIME_SYNC": 100, "API_LOGIN": 100, "FETCH": 100,
+    "SAVE": 50, "LOAD": 50, "RENDER": 45, "REFRESH": 40, "SHUTDOWN": 40,
+}
+
+
+def read_log(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if len(data) < HEADER.size:
+        sys.exit("%s: too short for a wake log" % path)
+    magic, version, record_size, phase_count, capacity, _next, count, _seq = HEADER.unpack_from(data)
+    if magic != LOG_MAGIC or version != LOG_VERSION:
+        sys.exit("%s: not a version %d wake log" % (path, LOG_VERSION))
+    if phase_count != len(PHASES):
+        sys.exit("%s: has %d phases, this decoder knows %d" % (path, phase_count, len(PHASES)))
+    expected = RECORD_HEAD.size + phase_count * PHASE.size + 4
+    if record_size != expected:
+        sys.exit("%s: record size %d, expected %d" % (path, record_size, expected))
+
+    records, damaged = [], 0
+    for slot in range(min(count, capacity)):
+        offset = HEADER.size + slot * record_size
+        raw = data[offset:offset + record_size]
+        if len(raw) < record_size:
+            damaged += 1
+            continue
+        (crc,) = struct.unpack_from("<I", raw, record_size - 4)
+        if zlib.crc32(raw[:-4]) != crc:
+            damaged += 1
+            continue
+        seq, ts, battery_mv, cause, flags, total_int, total_psram, arena = RECORD_HEAD.unpack_from(raw)
+        phases = [PHASE.unpack_from(raw, RECORD_HEAD.size + i * PHASE.size) for i in range(phase_count)]
+        records.append({
+            "sequence": seq, "timestamp": ts, "battery_mv": battery_mv, "cause": cause,
+            "flags": flags, "total_internal": total_int, "total_psram": total_psram,
+            "render_arena": arena, "phases": phases,
+        })
+    records.sort(key=lambda r: r["sequence"])
+    return records, damaged
+
+
+def percentile(values, p):
+    if not values:
+        return 0.0
+    values = sorted(values)
+    k = (len(values) - 1) * p / 100.0
+    lo = int(k)
+    hi = min(lo + 1, len(values) - 1)
+    return values[lo] + (values[hi] - values[lo]) * (k - lo)
+
+
+def kind_of(record):
+    if record["flags"] & FLAG_VIEW_UPDATE:
+        return "view"
+    return "refresh"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("log", help="wake.bin copied off the SD card")
+    parser.add_argument("--days", type=float, help="only wakes in the last N days of the log")
+    parser.add_argument("--kind", choices=["refresh", "view"], help="only timer/refresh-button or view-button wakes")
+    parser.add_argument("--current", action="append", default=[], metavar="PHASE=mA",
+                        help="board current during a phase, for the charge estimate")
+    parser.add_argument("--csv", action="store_true", help="print the phase table as CSV")
+    args = parser.parse_args()
+
+    current = dict(DEFAULT_CURRENT_MA)
+    for item in args.current:
+        name, _, value = item.partition("=")
+        if name.upper() not in current:
+            sys.exit("Unknown phase %s" % name)
+        current[name.upper()] = float(value)
+
+    records, damaged = read_log(args.log)
+    if args.days is not None and records:
+        newest = max(r["timestamp"] for r in records)
+        records = [r for r in records if r["timestamp"] >= newest - args.days * 86400]
+    if args.kind:
+        records = [r for r in records if kind_of(r) == args.kind]
+    if not records:
+        sys.exit("No wakes to report (%d damaged records skipped)" % damaged)
+
+    first = datetime.datetime.fromtimestamp(records[0]["timestamp"], datetime.timezone.utc)
+    last = datetime.datetime.fromtimestamp(records[-1]["timestamp"], datetime.timezone.utc)
+    kinds = {}
+    for r in records:
+        kinds[kind_of(r)] = kinds.get(kind_of(r), 0) + 1
+    cached = sum(1 for r in records if r["flags"] & FLAG_CACHED_FRAME)
+    unchanged = sum(1 for r in records if r["flags"] & FLAG_UNCHANGED)
+    partial = sum(1 for r in records if r["flags"] & FLAG_PARTIAL_REFRESH)
+
+    rows = []
+    for i, name in enumerate(PHASES):
+        # Only the wakes that went through the phase
+        ran = [r for r in records if r["phases"][i][0] > 0]
+        ms = [r["phases"][i][0] / 1000.0 for r in ran]
+        internal = [r["total_internal"] - r["phases"][i][1] for r in ran]
+        psram = [r["total_psram"] - r["phases"][i][2] for r in ran]
+        rows.append((name, len(ran), percentile(ms, 50), percentile(ms, 90), percentile(ms, 99),
+                     max(ms) if ms else 0.0, max(internal) if internal else 0, max(psram) if psram else 0))
+
+    if args.csv:
+        print("phase,wakes,p50_ms,p90_ms,p99_ms,max_ms,internal_high_water,psram_high_water")
+        for row in rows:
+            print("%s,%d,%.1f,%.1f,%.1f,%.1f,%d,%d" % row)
+        return
+
+    print("%d wakes from %s to %s UTC (%s), %d drawn from a cached frame, %d left the panel unchanged, "
+          "%d refreshed the status bar only, %d damaged records skipped"
+          % (len(records), first.strftime("%Y-%m-%d %H:%M"), last.strftime("%Y-%m-%d %H:%M"),
+             ", ".join("%d %s" % (n, k) for k, n in sorted(kinds.items())), cached, unchanged, partial, damaged))
+    print()
+    print("%-10s %6s %9s %9s %9s %9s %12s %12s" % ("phase", "wakes", "p50 ms", "p90 ms", "p99 ms", "max ms",
+                                                 "heap peak", "psram peak"))
+    for row in rows:
+        print("%-10s %6d %9.1f %9.1f %9.1f %9.1f %12d %12d" % row)
+
+    totals = [sum(p[0] for p in r["phases"]) / 1000.0 for r in records]
+    charge = [sum(r["phases"][i][0] / 1e6 * current[name] for i, name in enumerate(PHASES)) / 3600.0
+              for r in records]
+    print()
+    print("Awake per wake: p50 %.0f ms, p90 %.0f ms, max %.0f ms"
+          % (percentile(totals, 50), percentile(totals, 90), max(totals)))
+    span_days = max((records[-1]["timestamp"] - records[0]["timestamp"]) / 86400.0, 1.0 / 24)
+    print("Estimated charge: %.3f mAh per wake, %.2f mAh per day awake"
+          % (sum(charge) / len(charge), sum(charge) / span_days))
+    arenas = [r["render_arena"] for r in records if r["render_arena"] > 0]
+    if arenas:
+        print("Render arena: p50 %.0f KB, max %.0f KB over %d drawn frames"
+              % (percentile(arenas, 50) / 1024.0, max(arenas) / 1024.0, len(arenas)))
+    volts = [r["battery_mv"] for r in records if r["battery_mv"] > 0]
+    if volts:
+        print("Battery: %.2f V at the first wake, %.2f V at the last" % (volts[0] / 1000.0, volts[-1] / 1000.0))
+
+
+if __name__ == "__main__":
+    main()